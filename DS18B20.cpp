@@ -29,13 +29,48 @@ written by Enrico Formenti
 
 #include "DS18B20.h"
 
-void DS18B20::begin(void) {
-  uint8_t i;
+// Timings and counters of the component
+#if ONEWIRE_STATS
+#define SENSOR_STATS (&_sensorStats)
+#define SENSOR_STAT_INC(field) (_sensorStats.field++)
+#else
+#define SENSOR_STATS ((DS18B20stats *)NULL)
+#define SENSOR_STAT_INC(field) ((void)0)
+#endif
+
+// Transactions used by this component, they all address the device itself
+static const OWtransaction PROGMEM txn_read_scratchpad =
+	{ OW_TXN_RESET | OW_TXN_MATCH | OW_TXN_CRC8, 1, { CMD_READ_SCRATCHPAD }, 0, 9 };
+static const OWtransaction PROGMEM txn_write_scratchpad =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_WRITE_SCRATCHPAD }, 3, 0 };
+// the DS18S20 has no configuration register
+static const OWtransaction PROGMEM txn_write_alarms =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_WRITE_SCRATCHPAD }, 2, 0 };
+static const OWtransaction PROGMEM txn_start_conversion =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_START_CONVERSION }, 0, 0 };
+static const OWtransaction PROGMEM txn_read_power_supply =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_READ_POWER_SUPPLY }, 0, 0 };
+static const OWtransaction PROGMEM txn_copy_scratchpad =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_COPY_SCRATCHPAD }, 0, 0 };
+static const OWtransaction PROGMEM txn_recall_eeprom =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_RECALL_EEPROM }, 0, 0 };
+static const OWtransaction PROGMEM txn_read_temperature =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_READ_SCRATCHPAD }, 0, 2 };
+
+void DS18B20::begin(uint8_t family) {
 	
+	_res = 12;
 	_isAlarmOn = false;
 	_isAlarmTriggered = false;
+	_isConverting = false;
+	_isTimedOut = false;
 	_alarm_tmax = 0;
 	_alarm_tmin = 0;
+	// factory settings, until the component is read
+	_config[0] = _config[1] = 0;
+	_config[2] = 0x7F;
+	_isConfigSaved = false;
+	_lastRaw = DS18B20_NO_SAMPLE;
 		
 //	pinMode(_pin, INPUT);
 //	bitmask = PIN_TO_BITMASK(_pin);
@@ -44,7 +79,7 @@ void DS18B20::begin(void) {
 	reset_search();
 #endif
 	
-	if( !search(_adr, CMD_GENERIC_SEARCH) ) {
+	if( !(family ? search_family(_adr, family) : search(_adr, CMD_GENERIC_SEARCH)) ) {
 		setError(ERROR_NO_MORE_ADDRESSES);
 		reset_search();
 		return;
@@ -56,65 +91,294 @@ void DS18B20::begin(void) {
 	
 	_isParasitePower = getPowerSupplyMode();
 	
-	// present = 0neWire::reset();
-	reset();
-	select(_adr);
-	write(CMD_READ_SCRATCHPAD);    // read scratchpad
-	
-	for(i=0;i<9;i++)
-		_scratchpad[i] = OWcomponent::read();
-	
-	if(crc8(_scratchpad, 8) != _scratchpad[SCRATCHPAD_CRC]) {
-		setError(ERROR_INVALID_CRC);
+	if(execute_P(&txn_read_scratchpad, _adr, _scratchpad) != ERROR_NONE) {
 		_res = 12;  // set default increments and resolution
 //		_resInc = .0625;
 		return;
 	}
-		
+	
+	// at power on the component loads its settings from EEPROM
+	memcpy(_config, &_scratchpad[HIGH_ALARM_TEMP], 3);
+	_isConfigSaved = true;
+	
+	if(isDS18S20()) {
+		_res = 9;
+		return;
+	}
 	_res = 9 + (((_scratchpad[CONFIGURATION] & 0x60) << 1)>>6); // read # of resolution bits from configuration reg
 //	_resInc = .0625 * (1<<(12-_res));  // increments	
 }
 
 
 float DS18B20::getTemperature(void) {
-	uint8_t i;
-	uint16_t tmp;
 	
-	reset();
-	select(_adr);
-//	OneWire::write(0x44,1);  // start temperature measurement and A/D conversion
-	write(CMD_START_CONVERSION, _isParasitePower);    // start temperature measurement and A/D conversion
-	if(_isParasitePower)  // just in case since after we have a delay instruction
-		depower();
-	
-	// wait for conversion to finish
-	delay(1000/(1<<(12-_res))); // conversion time is proportional to resolution
-	                            // 750 should be enough for 12 bit resolution according to manual
-	                            // here we add some extra delay to be absolutely sure...
-	
-	// present = OneWire::reset();
-	reset();
-	select(_adr);
-	write(CMD_READ_SCRATCHPAD, _isParasitePower);    // read scratchpad
+	if(!startConversion())
+		return 0;
 	
-	for(i=0;i<9;i++)
-		_scratchpad[i] = OWcomponent::read();
+	while(!isConversionReady())
+		;
 	
-	if(crc8(_scratchpad, 8) != _scratchpad[SCRATCHPAD_CRC]) {
-		setError(ERROR_INVALID_CRC);
-		return 0;
+	return readTemperature();
+}
+
+boolean DS18B20::startConversion(void) {
+	
+	// start temperature measurement and A/D conversion, a parasite powered
+	// device draws its current from the strong pullup until it is done
+	if(execute_P(&txn_start_conversion, _adr, NULL, _isParasitePower ? OW_TXN_PULLUP : 0) != ERROR_NONE)
+		return false;
+	
+	// conversion time is proportional to resolution, 750 should be enough
+	// for 12 bit resolution according to manual.
+	// In parasite mode the next transaction waits for the end of the pullup window.
+	if(_isParasitePower)
+		strong_pullup(conversionTime());
+	_convStart = millis();
+	_convEpoch = getEpoch();
+	_isConverting = true;
+	_isTimedOut = false;
+	
+	return true;
+}
+
+boolean DS18B20::isConversionReady(void) {
+	
+	unsigned long elapsed;
+	
+	if(!_isConverting)
+		return true;
+	
+	if(_isParasitePower) {
+		if(pullup_active())
+			return false;
 	}
+	else {
+		elapsed = millis() - _convStart;
+		// the component answers the read slots until the next reset only
+		if(elapsed <= conversionTime()) {
+			if(getEpoch() != _convEpoch || !read_bit())
+				return false;
+		}
+		else if(getEpoch() == _convEpoch && !read_bit()) {
+			// kept for the reads of the result, which clear the error
+			_isTimedOut = true;
+			setError(ERROR_TIME_OUT);
+		}
+	}
+	
+	_convTime = millis() - _convStart;
+	recordConversion(SENSOR_STATS, _convTime);
+	_isConverting = false;
+	return true;
+}
+
+float DS18B20::readTemperature(void) {
+	
+	return (float)readRawTemperature()/16;
+}
+
+int16_t DS18B20::getRawTemperature(void) {
+	
+	if(!startConversion())
+		return 0;
+	
+	while(!isConversionReady())
+		;
+	
+	return readRawTemperature();
+}
+
+int16_t DS18B20::readRawTemperature(boolean fast) {
+	int16_t tmp, suspect = DS18B20_NO_SAMPLE;
+	uint8_t n;
+	uint16_t e;
+	
+	for(n = 0; ; n++) {
+		e = fetch(fast, &tmp);
+		if(e == ERROR_NONE)
+			e = checkReading(_scratchpad, fast ? 2 : 9, tmp, _lastRaw, suspect, _maxJump);
+		if(e == ERROR_NONE || e == ERROR_NO_PRESENCE || e == ERROR_TIME_OUT || n >= _retries)
+			break;
 		
-	tmp = (_scratchpad[TEMP_MSB]<<8)|_scratchpad[TEMP_LSB];
-	tmp >>= (12-_res);
-//	if (_data[1] & 0x80) 
-//		tmp = (1+~tmp);
+		// retry with the CRC, after a new conversion if the value itself is suspicious
+		SENSOR_STAT_INC(retries);
+		fast = false;
+		if(e == ERROR_POWER_ON_RESET || e == ERROR_IMPLAUSIBLE_VALUE) {
+			SENSOR_STAT_INC(reconversions);
+			suspect = tmp;
+			if(!startConversion()) {
+				SENSOR_STAT_INC(failures);
+				return 0;
+			}
+			while(!isConversionReady())
+				;
+		}
+	}
+	if(e != ERROR_NONE) {
+		SENSOR_STAT_INC(failures);
+		setError(e);
+		return 0;
+	}
 	
-//	tmp = (tmp<<(16-_res))>>(16-_res);
+	adapt(tmp);
+	_lastRaw = tmp;
+	return tmp;
+}
+
+uint16_t DS18B20::fetch(boolean fast, int16_t *raw) {
+#if ONEWIRE_STATS
+	unsigned long t0 = micros();
+#endif
 	
-//	if(_data[1] & 0x80) // if it is a negative number and it's a 2-complement number...
-//	return (tmp>>4)+(tmp & 0xF)*_resInc;
-	return (float)tmp/((1.0)*(1<<(_res-8)));
+	// the scratchpad still holds the previous value
+	if(_isTimedOut)
+		return ERROR_TIME_OUT;
+	if(fast) {
+		// TEMP_LSB and TEMP_MSB only, the reset stops the component
+		clearError();
+		if(execute_P(&txn_read_temperature, _adr, _scratchpad) == ERROR_NONE)
+			reset();
+	}
+	else
+		read();
+#if ONEWIRE_STATS
+	recordRead(SENSOR_STATS, micros() - t0, getSelectTime(), getError());
+#endif
+	if(getError() != ERROR_NONE)
+		return getError();
+	
+	*raw = (int16_t)((_scratchpad[TEMP_MSB]<<8)|_scratchpad[TEMP_LSB]);
+	if(isDS18S20())
+		// the fast read only gets the 0.5°C register
+		*raw = fast ? *raw*8 : scratchpadToRaw(_scratchpad, FAM_CODE_DB18S20);
+	else
+		// two's complement: clearing the undefined bits rounds towards minus infinity
+		*raw &= ~((1<<(12-_res))-1);
+	return ERROR_NONE;
+}
+
+uint16_t DS18B20::checkReading(const uint8_t *sp, uint8_t len, int16_t raw, int16_t last, int16_t suspect,
+	int16_t maxJump) {
+	uint8_t i, ones = 0xFF, zeros = 0;
+	
+	for(i = 0; i < len; i++) {
+		ones &= sp[i];
+		zeros |= sp[i];
+	}
+	if(len > 2 && (ones == 0xFF || !zeros))
+		return ERROR_READ_FAILURE;
+	
+	// a value close to the previous one, or confirming the rejected one, is trusted
+	if(last != DS18B20_NO_SAMPLE && raw - last <= maxJump && last - raw <= maxJump)
+		return ERROR_NONE;
+	if(suspect != DS18B20_NO_SAMPLE && raw - suspect <= maxJump && suspect - raw <= maxJump)
+		return ERROR_NONE;
+	
+	if(raw == DS18B20_POWER_ON_RAW)
+		return ERROR_POWER_ON_RESET;
+	if(last != DS18B20_NO_SAMPLE)
+		return ERROR_IMPLAUSIBLE_VALUE;
+	return ERROR_NONE;
+}
+
+int16_t DS18B20::scratchpadToRaw(const uint8_t *sp, uint8_t family) {
+	int16_t t = (int16_t)((sp[TEMP_MSB]<<8)|sp[TEMP_LSB]);
+	
+	if(family != FAM_CODE_DB18S20)
+		return t;
+	if(!sp[COUNT_PER_C])
+		return t*8;
+	
+	// (TEMP_READ with bit 0 dropped) * 16 - 4 + 16 * (COUNT_PER_C - COUNT_REMAIN) / COUNT_PER_C
+	return (t & ~1)*8 - 4 + (int16_t)(((sp[COUNT_PER_C] - sp[COUNT_REMAIN]) << 4) / sp[COUNT_PER_C]);
+}
+
+boolean DS18B20::setAdaptive(uint8_t minRes, uint16_t latency, int16_t threshold) {
+	uint8_t r;
+	
+	if(isDS18S20() || minRes<9 || minRes>12 || conversionTime(minRes) > latency) {
+		setError(ERROR_OUT_OF_RANGE);
+		return false;
+	}
+	
+	// best resolution within the latency budget
+	for(r = 12; conversionTime(r) > latency; r--)
+		;
+	
+	_minRes = minRes;
+	_maxRes = r;
+	_adaptThreshold = threshold;
+	
+	// start fast, the first stable readings raise the resolution
+	setResolution(minRes);
+	return true;
+}
+
+void DS18B20::adapt(int16_t raw) {
+	uint8_t r = _res;
+	int16_t delta;
+	
+	if(!_maxRes)
+		return;
+	
+	delta = (_lastRaw == DS18B20_NO_SAMPLE) ? 0 : raw - _lastRaw;
+	if(delta > _adaptThreshold || delta < -_adaptThreshold)
+		r = _minRes;
+	else if(_res < _maxRes)
+		r = _res + 1;
+	else if(_res > _maxRes)
+		r = _maxRes;
+	
+	if(r != _res)
+		setResolution(r);
+}
+
+void DS18B20::getSensorStats(DS18B20stats *s) {
+	
+#if ONEWIRE_STATS
+	memcpy(s, &_sensorStats, sizeof(DS18B20stats));
+#else
+	memset(s, 0, sizeof(DS18B20stats));
+#endif
+}
+
+void DS18B20::clearSensorStats(void) {
+	
+#if ONEWIRE_STATS
+	memset(&_sensorStats, 0, sizeof(DS18B20stats));
+#endif
+}
+
+void DS18B20::recordConversion(DS18B20stats *s, uint16_t ms) {
+	
+#if ONEWIRE_STATS
+	if(!s)
+		return;
+	s->convLast = ms;
+	if(ms > s->convMax)
+		s->convMax = ms;
+#endif
+}
+
+void DS18B20::recordRead(DS18B20stats *s, uint16_t us, uint16_t select, uint16_t e) {
+	
+#if ONEWIRE_STATS
+	if(!s)
+		return;
+	s->reads++;
+	s->readLast = us;
+	if(us > s->readMax)
+		s->readMax = us;
+	s->selectLast = select;
+	if(e == ERROR_INVALID_CRC)
+		s->crcErrors++;
+#endif
+}
+
+void DS18B20::read(void) {
+	
+	clearError();
+	execute_P(&txn_read_scratchpad, _adr, _scratchpad);
 }
 
 /**************
@@ -126,23 +390,16 @@ float DS18B20::getTemperature(void) {
  **************/
 void DS18B20::setResolution(uint8_t r) {
 	
-	if(r<9 || r>12) {
+	if(r<9 || r>12 || (isDS18S20() && r != 9)) {
 		setError(ERROR_OUT_OF_RANGE);
 		return;
 	}
-	_res = r;
-	
-	_datatmp[0]=_scratchpad[HIGH_ALARM_TEMP];
-	_datatmp[1]=_scratchpad[LOW_ALARM_TEMP];
-	_datatmp[2]=_scratchpad[CONFIGURATION];
-	
-	_datatmp[2] |= ((12-r)<<5); 
+	if(isDS18S20())
+		return;
 	
-	reset();
-	select(_addr);
-	OWcomponent::write_bytes(_datatmp, 3, _isParasitePower);
-	if(_isParasitePower)
-		depower();
+	// R1 R0 are bits 6 and 5, lower bits read as 1
+	if(writeConfig(_config[0], _config[1], ((r-9)<<5)|0x1F))
+		_res = r;
 }
 
 void DS18B20::setAlarm(int tmin, int tmax) {
@@ -153,41 +410,108 @@ void DS18B20::setAlarm(int tmin, int tmax) {
 	}
 	
 	_isAlarmOn = true;
+	_isAlarmTriggered = false;
 		
 	_alarm_tmin = tmin;
 	_alarm_tmax = tmax;
 	
-	_datatmp[0]=tmin;
-	_datatmp[1]=tmax;
+	// TH and TL, two's complement
+	if(writeConfig((uint8_t)tmax, (uint8_t)tmin, _config[2])) {
+		_scratchpad[HIGH_ALARM_TEMP] = _config[0];
+		_scratchpad[LOW_ALARM_TEMP] = _config[1];
+	}
+}
+
+boolean DS18B20::writeConfig(uint8_t th, uint8_t tl, uint8_t cfg) {
+	
+	if(th == _config[0] && tl == _config[1] && cfg == _config[2])
+		return true;
 	
-	reset();
-	select(_addr);
-	write_bytes(_datatmp, 2, _isParasitePower);  
-	if(_isParasitePower)
-		depower();
+	// TH, TL and configuration register are always written together
+	_datatmp[0]=th;
+	_datatmp[1]=tl;
+	_datatmp[2]=cfg;
+	
+	if(execute_P(isDS18S20() ? &txn_write_alarms : &txn_write_scratchpad, _adr, _datatmp) != ERROR_NONE)
+		return false;
+	
+	memcpy(_config, _datatmp, 3);
+	_scratchpad[CONFIGURATION] = cfg;
+	_isConfigSaved = false;
+	return true;
 }
 
-boolean DS18B20::isAlarmTriggered(void) {
+boolean DS18B20::saveConfig(void) {
 	
-	uint8_t temp;
+	if(_isConfigSaved)
+		return true;
 	
-	if(!_isAlarmOn)
+	// a parasite powered device draws its current from the strong pullup
+	if(execute_P(&txn_copy_scratchpad, _adr, NULL, _isParasitePower ? OW_TXN_PULLUP : 0) != ERROR_NONE)
 		return false;
 	
-	temp = _scratchpad[LOW_ALARM_TEMP]|(_scratchpad[HIGH_ALARM_TEMP]<<8);
+	if(_isParasitePower) {
+		strong_pullup(DS18B20_COPY_TIME);
+		pullup_wait();
+	}
+	else if(!waitDone(DS18B20_COPY_TIME))
+		return false;
 	
-	if( temp <= _alarm_tmin || temp >= _alarm_tmax)
+	_isConfigSaved = true;
+	return true;
+}
+
+boolean DS18B20::recallConfig(void) {
+	
+	if(execute_P(&txn_recall_eeprom, _adr) != ERROR_NONE)
+		return false;
+	if(!waitDone(DS18B20_COPY_TIME))
+		return false;
+	
+	read();
+	if(getError() != ERROR_NONE)
+		return false;
+	
+	memcpy(_config, &_scratchpad[HIGH_ALARM_TEMP], 3);
+	_res = isDS18S20() ? 9 : 9 + ((_config[2] >> 5) & 0x03);
+	_isConfigSaved = true;
+	return true;
+}
+
+boolean DS18B20::waitDone(uint16_t ms) {
+	unsigned long start = millis();
+	
+	// the component answers 0 to the read slots until it is done
+	while(!read_bit())
+		if(millis() - start > ms) {
+			setError(ERROR_TIME_OUT);
+			return false;
+		}
+	return true;
+}
+
+boolean DS18B20::isAlarmTriggered(void) {
+	
+	if(!_isAlarmOn)
+		return false;
+	if(_isAlarmTriggered)
 		return true;
+	if(_lastRaw == DS18B20_NO_SAMPLE)
+		return false;
+	
+	// the component compares the integer part (rounded down) of the last
+	// conversion with TH and TL
+	if((_lastRaw >> 4) <= _alarm_tmin || (_lastRaw >> 4) >= _alarm_tmax)
+		_isAlarmTriggered = true;
 
-	return false;
+	return _isAlarmTriggered;
 }
 
 boolean DS18B20::getPowerSupplyMode(void) {
 	boolean retval = false;
 	
-	reset();
-	select(_adr);
-	write(CMD_READ_POWER_SUPPLY);
+	if(execute_P(&txn_read_power_supply, _adr) != ERROR_NONE)
+		return false;
 	
 	if (read_bit() == 0) 
 		retval = true;
@@ -35,7 +35,7 @@
 #ifndef DS18B20_H
 #define DS18B20_H
 
-#include <Math.h>
+#include <math.h>
 #include "OWcomponent.h"
 #include "Sensor.h"
 #include "Error.h"
@@ -51,7 +51,68 @@ written by Enrico Formenti
 #define CMD_READ_POWER_SUPPLY 0xB4
 #define CMD_READ_SCRATCHPAD 0xBE
 #define CMD_START_CONVERSION 0x44
-#define CMD_WRITE_SCRATCHPAD 0x0
+#define CMD_WRITE_SCRATCHPAD 0x4E
+#define CMD_COPY_SCRATCHPAD 0x48
+#define CMD_RECALL_EEPROM 0xB8
+
+/**
+ \def DS18B20_CONVERSION_TIME 750
+ \brief Time (in milliseconds) needed by a DS18B20 for a 12 bits conversion, at most. It is halved for each bit
+ of resolution less.
+ */
+#define DS18B20_CONVERSION_TIME 750
+/**
+ \def DS18B20_COPY_TIME 10
+ \brief Time (in milliseconds) needed by a DS18B20 to copy its scratchpad into EEPROM, at most.
+ */
+#define DS18B20_COPY_TIME 10
+/**
+ \def DS18B20_ADAPTIVE_THRESHOLD 8
+ \brief Default change (in 1/16 of Celsius degree) between two readings above which the temperature is considered
+ as moving, see \c DS18B20::setAdaptive().
+ */
+#define DS18B20_ADAPTIVE_THRESHOLD 8
+/**
+ \def DS18B20_POWER_ON_RAW 0x0550
+ \brief Temperature register after a power-on reset (85°C), in 1/16 of Celsius degree. A DS18S20 gives the same
+ value once extended.
+ */
+#define DS18B20_POWER_ON_RAW 0x0550
+/**
+ \def DS18B20_NO_SAMPLE
+ \brief Stands for a missing previous reading, no temperature can take this value.
+ */
+#define DS18B20_NO_SAMPLE ((int16_t)0x8000)
+/**
+ \def DS18B20_MAX_JUMP 160
+ \brief Default change (in 1/16 of Celsius degree) between two readings above which the last one is checked by a
+ new conversion, see \c DS18B20::setValidation().
+ */
+#define DS18B20_MAX_JUMP 160
+/**
+ \def DS18B20_RETRIES 1
+ \brief Default number of times a rejected reading is retried, see \c DS18B20::setValidation().
+ */
+#define DS18B20_RETRIES 1
+
+/**
+ \struct DS18B20stats
+ \brief Where the time goes for one sensor, see \c DS18B20::getSensorStats() and \c DS18B20group::setStats().
+ \details Kept unless \c ONEWIRE_STATS is defined to 0, all fields stay at 0 then. Times are those of the last
+ operation, or the longest one (\c convMax, \c readMax).
+ */
+typedef struct {
+	uint16_t convLast;       // wait for the last conversion, in milliseconds
+	uint16_t convMax;        // longest wait for a conversion, in milliseconds
+	uint16_t readLast;       // last scratchpad read, select included, in microseconds
+	uint16_t readMax;        // longest scratchpad read, in microseconds
+	uint16_t selectLast;     // reset and ROM command of the last read, in microseconds
+	uint16_t reads;          // scratchpad reads
+	uint16_t crcErrors;      // scratchpad reads failing the CRC
+	uint16_t retries;        // reads done again after a rejected reading
+	uint16_t reconversions;  // conversions done again for a retry
+	uint16_t failures;       // readings given up (error raised)
+} DS18B20stats;
 
 // Scratchpad locations
 #define TEMP_LSB        0
@@ -68,41 +129,259 @@ written by Enrico Formenti
 class DS18B20: public Sensor, public OWcomponent {
 private:
   uint8_t _pin;
-	uint8_t _addr[8];
 	uint8_t _datatmp[3];
+	/**
+	 \var uint8_t _config[3]
+	 \brief TH, TL and configuration register of the component, as last read or written successfully.
+	 */
+	uint8_t _config[3];
+	/**
+	 \var boolean _isConfigSaved
+	 \brief \c True if \c _config is also in the EEPROM of the component.
+	 */
+	boolean _isConfigSaved;
 	uint8_t _res;
 //	float _resInc;
 	int _alarm_tmin, _alarm_tmax;
 	boolean _isAlarmOn;
 	boolean _isAlarmTriggered;	
 	boolean _isParasitePower;
+	unsigned long _convStart;
+	uint16_t _convTime;
+	uint8_t _convEpoch;
+	boolean _isConverting;
+	/**
+	 \var boolean _isTimedOut
+	 \brief \c True if the last conversion did not end in time: the scratchpad holds a stale value.
+	 */
+	boolean _isTimedOut;
+	boolean _isFastRead;
+	// adaptive resolution, _maxRes is 0 when disabled
+	uint8_t _minRes, _maxRes;
+	int16_t _adaptThreshold;
+	/**
+	 \var int16_t _lastRaw
+	 \brief Last reading accepted, \c DS18B20_NO_SAMPLE if none.
+	 */
+	int16_t _lastRaw;
+	int16_t _maxJump;
+	uint8_t _retries;
+#if ONEWIRE_STATS
+	DS18B20stats _sensorStats;
+#endif
+	
+	/**
+	 \fn uint16_t conversionTime(void)
+	 \brief Returns the longest time (in milliseconds) a conversion takes at the current resolution.
+	 */
+	inline uint16_t conversionTime(void) { return isDS18S20() ? DS18B20_CONVERSION_TIME : conversionTime(_res); }
+	/**
+	 \fn static uint16_t conversionTime(uint8_t r)
+	 \brief Returns the longest time (in milliseconds) a conversion takes at resolution \c r.
+	 */
+	static inline uint16_t conversionTime(uint8_t r) { return (DS18B20_CONVERSION_TIME+(1<<(12-r))-1)>>(12-r); }
+	/**
+	 \fn void adapt(int16_t raw)
+	 \brief Chooses the resolution of the next conversion from the reading \c raw, in adaptive mode.
+	 */
+	void adapt(int16_t raw);
+	/**
+	 \fn uint16_t fetch(boolean fast, int16_t *raw)
+	 \brief Reads the temperature held in the scratchpad once, see \c readRawTemperature().
+	 \return \c ERROR_NONE or the error code, which is not raised.
+	 */
+	uint16_t fetch(boolean fast, int16_t *raw);
 	
 	/**
 	 \fn boolean getPowerSupplyMode(void)
 	 \brief Returns \c True if this component is in parasite power mode (ie only two pins are used), \c False otherwise.
 	 */
 	boolean getPowerSupplyMode(void);
+	/**
+	 \fn boolean writeConfig(uint8_t th, uint8_t tl, uint8_t cfg)
+	 \brief Writes TH, TL and the configuration register into the scratchpad, unless they are already there.
+	 \return \c True if the component holds these values, \c False otherwise (the error is raised).
+	 */
+	boolean writeConfig(uint8_t th, uint8_t tl, uint8_t cfg);
+	/**
+	 \fn boolean waitDone(uint16_t ms)
+	 \brief Waits for the end of a copy or recall started by the last command, at most \c ms milliseconds.
+	 \return \c True if the component is done, \c False otherwise (\c ERROR_TIME_OUT is raised).
+	 */
+	boolean waitDone(uint16_t ms);
 
 protected:
-	uint8_t _scratchpad[8];
+	uint8_t _scratchpad[9];
 	/**
-	 \fn void begin(void)
-	 \brief Initializes the component internals. In particular, it obtains an address on the 1-Wire bus.
+	 \fn void read(void)
+	 \brief Reads the scratchpad of the component into \c _scratchpad. In case of failure the error of the bus is raised.
 	 */
-	void begin(void);
+	void read(void);
+	/**
+	 \fn DS18B20(uint32_t id, uint8_t p) : Sensor(id,ST_TEMPERATURE), OWcomponent(p)
+	 \brief Constructor for the derived classes, which report their own sensor id.
+	 @param id Sensor id, see SensorConstants.h.
+	 @param p The Arduino pin to which the data pin of the component is connected to.
+	 */
+	inline DS18B20(uint32_t id, uint8_t p) : Sensor(id,ST_TEMPERATURE), OWcomponent(p) { _isAlarmOn = false; _isConverting = false; _isTimedOut = false; _isFastRead = false; _convTime = 0; _maxRes = 0; _lastRaw = DS18B20_NO_SAMPLE; _maxJump = DS18B20_MAX_JUMP; _retries = DS18B20_RETRIES; clearSensorStats(); };
 	
 public:
 	/**
-	 \fn DS18B20(uint8_t p) : Sensor(S_DS18B20,ST_TEMPERATURE)  : OWcomponent(p)
+	 \fn void begin(void)
+	 \brief Initializes the component internals. In particular, it obtains an address on the 1-Wire bus.
+	 \remark The first device found is used: a DS18S20 is handled too, see \c isDS18S20().
+	 */
+	inline void begin(void) { begin(0); }
+	/**
+	 \fn void begin(uint8_t family)
+	 \brief Same as above, but only devices having family code \c family (\c FAM_CODE_DB18B20 or
+	 \c FAM_CODE_DB18S20) are considered (\c 0 for any).
+	 */
+	void begin(uint8_t family);
+	/**
+	 \fn boolean isDS18S20(void)
+	 \brief Returns \c True if the component is a DS18S20 (or a DS1820).
+	 \details A DS18S20 has a fixed 9 bits temperature register (0.5°C steps) and no configuration register. The
+	 temperatures read are extended to 1/16°C with its COUNT_REMAIN and COUNT_PER_C registers, except by the fast
+	 read. The alarm bounds work the same, the resolution cannot be changed and is reported as 9 bits.
+	 */
+	inline boolean isDS18S20(void) { return _adr[0] == FAM_CODE_DB18S20; }
+	/**
+	 \fn static int16_t scratchpadToRaw(const uint8_t *sp, uint8_t family)
+	 \brief Returns the temperature held in scratchpad \c sp, in 1/16 of Celsius degree.
+	 \details For a DS18S20 (\c family is \c FAM_CODE_DB18S20) the extended resolution value is computed in fixed
+	 point: T = TEMP_READ - 0.25 + (COUNT_PER_C - COUNT_REMAIN) / COUNT_PER_C, where TEMP_READ is the temperature
+	 register with its 0.5°C bit dropped.
+	 */
+	static int16_t scratchpadToRaw(const uint8_t *sp, uint8_t family);
+	/**
+	 \fn static uint16_t checkReading(const uint8_t *sp, uint8_t len, int16_t raw, int16_t last, int16_t suspect, int16_t maxJump)
+	 \brief Tells if the temperature \c raw, read from the first \c len bytes of scratchpad \c sp, can be trusted.
+	 \details A whole scratchpad made of ones only is what the bus reads once the component is gone, one made of
+	 zeros passes the CRC: both are rejected. A fast read (two bytes) is not checked this way, as both are valid
+	 temperatures (0xFFFF is -0.0625°C, 0x0000 is 0°C). The power-on value and a change of more than
+	 \c maxJump since \c last are rejected too, unless \c raw is within \c maxJump of \c last (resp. of
+	 \c suspect, a value rejected before a new conversion that \c raw confirms).
+	 @param last Previous reading accepted, \c DS18B20_NO_SAMPLE if none.
+	 @param suspect Reading rejected just before, \c DS18B20_NO_SAMPLE if none.
+	 \return \c ERROR_NONE, \c ERROR_READ_FAILURE, \c ERROR_POWER_ON_RESET or \c ERROR_IMPLAUSIBLE_VALUE.
+	 */
+	static uint16_t checkReading(const uint8_t *sp, uint8_t len, int16_t raw, int16_t last, int16_t suspect,
+		int16_t maxJump);
+	/**
+	 \fn DS18B20(uint8_t p) : DS18B20(S_DS18B20, p)
 	 \brief Constructor
 	 @param p The Arduino pin to which the data pin of DS18B20 is connected to.
+	 \remark A DS18S20 driven through this class, see \c begin(uint8_t), still reports \c S_DS18B20 as sensor id:
+	 use the \c DS18S20 class to get \c S_DS18S20.
 	 */
-	inline DS18B20(uint8_t p) : Sensor(S_DS18B20,ST_TEMPERATURE), OWcomponent(p) { _isAlarmOn = false; };
+	inline DS18B20(uint8_t p) : DS18B20(S_DS18B20, p) { };
 	/**
 	 \fn float getTemperature(void)
 	 \brief Returns the temperature in Celsius degrees.
+	 \remark This call blocks until the conversion is done (up to one second at 12 bits resolution), see
+	 \c startConversion() for the non blocking way.
 	 */
 	float getTemperature(void);
+	/**
+	 \fn boolean startConversion(void)
+	 \brief Starts a temperature conversion and returns at once.
+	 \return \c True if the conversion has been started, \c False otherwise (the error is raised).
+	 \remark In parasite power mode the bus is held high until the conversion is done: any other transaction on this
+	 bus waits for it.
+	 @see isConversionReady, readTemperature.
+	 */
+	boolean startConversion(void);
+	/**
+	 \fn boolean isConversionReady(void)
+	 \brief Returns \c True if the conversion started by \c startConversion() is done, \c False otherwise.
+	 \details An externally powered component is asked with a read slot: it answers 1 as soon as it is done, which
+	 is usually well before the time given by the datasheet. If the bus has been reset since \c startConversion()
+	 the component does not answer anymore and the longest conversion time is waited instead. In parasite power
+	 mode the longest conversion time is always waited.
+	 \remark If the component is still busy after the longest conversion time, \c ERROR_TIME_OUT is raised and
+	 \c True is returned. The reads of the result fail with \c ERROR_TIME_OUT too, until the next conversion.
+	 */
+	boolean isConversionReady(void);
+	/**
+	 \fn uint16_t getConversionTime(void)
+	 \brief Returns the time (in milliseconds) taken by the last conversion.
+	 */
+	inline uint16_t getConversionTime(void) { return _convTime; }
+	/**
+	 \fn float readTemperature(void)
+	 \brief Reads the result of the last conversion, in Celsius degrees.
+	 \remark If the conversion is not done yet, the previous value (or the power-on value 85°C) is returned.
+	 */
+	float readTemperature(void);
+	/**
+	 \fn int16_t getRawTemperature(void)
+	 \brief Returns the temperature in 1/16 of Celsius degree, without using floating point.
+	 \remark Blocking, like \c getTemperature(). In case of failure \c 0 is returned and the error is raised.
+	 */
+	int16_t getRawTemperature(void);
+	/**
+	 \fn int16_t getCentiTemperature(void)
+	 \brief Returns the temperature in hundredths of Celsius degree, without using floating point.
+	 \remark Blocking, like \c getTemperature(). In case of failure \c 0 is returned and the error is raised.
+	 */
+	inline int16_t getCentiTemperature(void) { return rawToCenti(getRawTemperature()); }
+	/**
+	 \fn int16_t readRawTemperature(boolean fast)
+	 \brief Reads the result of the last conversion, in 1/16 of Celsius degree.
+	 \details The bits below the current resolution, which the component leaves undefined, are cleared: the value
+	 is a multiple of 8, 4, 2 or 1 at 9, 10, 11 or 12 bits, for negative temperatures too.
+	 @param fast If \c True only the two temperature bytes are read, then the transfer is aborted by a reset. This
+	 saves 56 read slots (about 4 ms at standard speed) but the CRC cannot be checked. Otherwise the whole
+	 scratchpad is read and its CRC is checked.
+	 \remark Each reading is checked, see \c setValidation(). A rejected one is retried with the whole scratchpad;
+	 when the value itself is suspicious (power-on value, jump) a new conversion is waited for first, which blocks.
+	 In case of failure \c 0 is returned and the error is raised.
+	 */
+	int16_t readRawTemperature(boolean fast);
+	/**
+	 \fn int16_t readRawTemperature(void)
+	 \brief Same as above, the kind of read is chosen by \c setFastRead().
+	 */
+	inline int16_t readRawTemperature(void) { return readRawTemperature(_isFastRead); }
+	/**
+	 \fn void setFastRead(boolean f)
+	 \brief Selects how the temperature is read by default: only the two temperature bytes (\c True) or the whole
+	 scratchpad with CRC check (\c False, the default). See \c readRawTemperature().
+	 */
+	inline void setFastRead(boolean f) { _isFastRead = f; }
+	/**
+	 \fn boolean isFastRead(void)
+	 \brief Returns \c True if the temperature is read without the CRC by default.
+	 */
+	inline boolean isFastRead(void) { return _isFastRead; }
+	/**
+	 \fn int16_t readCentiTemperature(void)
+	 \brief Reads the result of the last conversion, in hundredths of Celsius degree.
+	 */
+	inline int16_t readCentiTemperature(void) { return rawToCenti(readRawTemperature()); }
+
+	/**
+	 \fn static constexpr int16_t rawToCenti(int16_t raw)
+	 \brief Converts a temperature in 1/16 of Celsius degree into hundredths of Celsius degree (rounded to nearest).
+	 */
+	static constexpr int16_t rawToCenti(int16_t raw) { return (int16_t)(((int32_t)raw*25 + (raw < 0 ? -2 : 2))/4); }
+	/**
+	 \fn static constexpr int16_t centiToRaw(int16_t c)
+	 \brief Converts a temperature in hundredths of Celsius degree into 1/16 of Celsius degree (rounded to nearest).
+	 */
+	static constexpr int16_t centiToRaw(int16_t c) { return (int16_t)(((int32_t)c*4 + (c < 0 ? -12 : 12))/25); }
+	/**
+	 \fn static constexpr int16_t celsiusToRaw(int8_t c)
+	 \brief Converts a temperature in Celsius degrees into 1/16 of Celsius degree.
+	 */
+	static constexpr int16_t celsiusToRaw(int8_t c) { return (int16_t)c*16; }
+	/**
+	 \fn static constexpr int8_t rawToCelsius(int16_t raw)
+	 \brief Returns the integer part of a temperature in 1/16 of Celsius degree, rounded towards minus infinity as
+	 the alarm comparator of the component does.
+	 */
+	static constexpr int8_t rawToCelsius(int16_t raw) { return (int8_t)(raw >> 4); }
 	/**
 	 \fn uint8_t getResolution(void)
 	 \brief Returns the resolution of the temperature value.
@@ -113,21 +392,104 @@ public:
 	inline uint8_t getResolution(void) { return _res; };
 	/**
 	 \fn uint8_t setResolution(uint8_t r)
-	 \brief Sets the resolution of the temperature value.
+	 \brief Sets the resolution of the temperature value. Nothing is sent if the component already has it.
+	 \remark The component forgets it at power off, unless \c saveConfig() is called.
 	 \return r Number of bits of resolution for the temperature value. Admissible values are 9, 10, 11, 12. 
 	 \remark This number should be multiplied by the basic step value (0.0625) to get the actual approximation in term of
 	 degrees.
 	 @see getResolution
 	 */	
 	void setResolution(uint8_t r);
+	/**
+	 \fn boolean setAdaptive(uint8_t minRes, uint16_t latency, int16_t threshold = DS18B20_ADAPTIVE_THRESHOLD)
+	 \brief Lets the resolution follow the temperature: low while it moves, for short conversions, and one bit more
+	 at each reading while it is stable, up to the best resolution allowed by \c latency.
+	 \details After each reading, if it differs from the previous one by more than \c threshold the resolution drops
+	 to \c minRes, otherwise it is increased by one bit. The conversion time halves for each bit less, from 750 ms
+	 at 12 bits down to 94 ms at 9 bits.
+	 @param minRes Lowest resolution accepted (precision budget), from 9 to 12 bits.
+	 @param latency Longest conversion time accepted, in milliseconds (latency budget).
+	 @param threshold Change between two readings, in 1/16 of Celsius degree, above which the temperature is
+	 considered as moving.
+	 \return \c True if the adaptive mode is on, \c False if the budgets cannot be met together (\c ERROR_OUT_OF_RANGE
+	 is raised and the resolution is left unchanged).
+	 \remark The resolution is only changed in the scratchpad, a power cycle brings back the one saved in EEPROM.
+	 @see clearAdaptive
+	 */
+	boolean setAdaptive(uint8_t minRes, uint16_t latency, int16_t threshold = DS18B20_ADAPTIVE_THRESHOLD);
+	/**
+	 \fn void clearAdaptive(void)
+	 \brief Leaves the adaptive mode, the current resolution is kept.
+	 */
+	inline void clearAdaptive(void) { _maxRes = 0; }
+	/**
+	 \fn boolean isAdaptive(void)
+	 \brief Returns \c True if the resolution follows the temperature, see \c setAdaptive().
+	 */
+	inline boolean isAdaptive(void) { return _maxRes != 0; }
+	/**
+	 \fn void setValidation(int16_t maxJump, uint8_t retries)
+	 \brief Sets how the readings are checked, see \c checkReading().
+	 @param maxJump Change since the previous reading, in 1/16 of Celsius degree, above which a new conversion is
+	 asked to confirm the value (\c DS18B20_MAX_JUMP by default).
+	 @param retries Number of retries of a rejected reading before giving up (\c DS18B20_RETRIES by default, \c 0
+	 reports every rejected reading as an error).
+	 */
+	inline void setValidation(int16_t maxJump, uint8_t retries) { _maxJump = maxJump; _retries = retries; }
+	
+	/**
+	 \fn void getSensorStats(DS18B20stats *s)
+	 \brief Copies the timings and counters of this component into \c s.
+	 \details Together with the counters of the bus (\c getStats()) they tell which of the resolution, the
+	 addressing mode or the bus layout costs the most.
+	 @see clearSensorStats
+	 */
+	void getSensorStats(DS18B20stats *s);
+	/**
+	 \fn void clearSensorStats(void)
+	 \brief Sets all the timings and counters of this component back to 0.
+	 */
+	void clearSensorStats(void);
+	/**
+	 \fn static void recordConversion(DS18B20stats *s, uint16_t ms)
+	 \brief Accounts a conversion wait of \c ms milliseconds in \c s.
+	 */
+	static void recordConversion(DS18B20stats *s, uint16_t ms);
+	/**
+	 \fn static void recordRead(DS18B20stats *s, uint16_t us, uint16_t select, uint16_t e)
+	 \brief Accounts in \c s a scratchpad read of \c us microseconds (\c select of them to address the
+	 component) ending with error code \c e.
+	 */
+	static void recordRead(DS18B20stats *s, uint16_t us, uint16_t select, uint16_t e);
 	/**
 	 \fn void setAlarm(int tmin, int tmax)
-	 \brief Sets the temperature bound beyond or below which the alarm is triggered.
+	 \brief Sets the temperature bound beyond or below which the alarm is triggered. Nothing is sent if the
+	 component already has these bounds.
 	 @param tmin If the temperature goes below this value the alarm is triggered. Minimal value is -55°C.
 	 @param tmax If the temperature goes beyond this value the alarm is triggered. Maximal value is +125°C.
 	 \remark Of course \c tmin has to be less or equal to \c tmax, otherwise an error is raised and the alarm is not set.
 	 */
 	void setAlarm(int tmin, int tmax);
+	/**
+	 \fn boolean saveConfig(void)
+	 \brief Copies the alarm bounds and the resolution into the EEPROM of the component, so that it comes up with
+	 them at power on. Nothing is sent if the EEPROM already holds them.
+	 \details The copy takes up to 10 ms. In parasite power mode the bus is held high meanwhile.
+	 \return \c True if the EEPROM holds the current settings, \c False otherwise (the error is raised).
+	 */
+	boolean saveConfig(void);
+	/**
+	 \fn boolean recallConfig(void)
+	 \brief Reloads the alarm bounds and the resolution from the EEPROM of the component, dropping the changes not
+	 saved.
+	 \return \c True if the settings have been reloaded, \c False otherwise (the error is raised).
+	 */
+	boolean recallConfig(void);
+	/**
+	 \fn boolean isConfigSaved(void)
+	 \brief Returns \c True if the current alarm bounds and resolution are also in the EEPROM of the component.
+	 */
+	inline boolean isConfigSaved(void) { return _isConfigSaved; }
 	/**
 	 \fn uint8_t getAlarmMin(void)
 	 \brief Returns the inferior bound in temperature for the alarm trigger.
@@ -144,7 +506,7 @@ public:
 	 \fn void resetAlarm(void)
 	 \brief Resets the current alarm flag. Use \c setAlarm to set a new alarm.
 	 */
-	inline void resetAlarm(void) { _isAlarmOn = false; }
+	inline void resetAlarm(void) { _isAlarmOn = false; _isAlarmTriggered = false; }
 	/**
 	 \fn boolean isAlarmSet(void)
 	 \brief Returns \c True if the alarm has been set, \c False otherwise.
@@ -154,6 +516,8 @@ public:
 	/**
 	 \fn boolean isAlarmTriggered(void)
 	 \brief Return \c True if an alarm event has been triggered, \c False otherwise.
+	 \details The integer part (rounded down) of the last temperature read is compared with the bounds, like the
+	 component does for the alarm search. The bus is not used: read a temperature first.
 	 \remark The alarm keep being triggered until reset by \c resetAlarm.
 	 @see isAlarmSet, setAlarm, resetAlarm.
 	 */
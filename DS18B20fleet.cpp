@@ -0,0 +1,87 @@
+/**
+ \file DS18B20fleet.cpp
+ \brief Implementation of the DS18B20fleet class.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "DS18B20fleet.h"
+
+static const OWtransaction PROGMEM txn_read_scratchpad =
+	{ OW_TXN_RESET | OW_TXN_MATCH | OW_TXN_CRC8, 1, { CMD_READ_SCRATCHPAD }, 0, 9 };
+static const OWtransaction PROGMEM txn_write_scratchpad =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_WRITE_SCRATCHPAD }, 3, 0 };
+// the DS18S20 has no configuration register
+static const OWtransaction PROGMEM txn_write_alarms =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_WRITE_SCRATCHPAD }, 2, 0 };
+
+DS18B20fleet::DS18B20fleet(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max) : DS18B20group(bus, roms, max) {
+	_handler = NULL;
+}
+
+bool DS18B20fleet::setAlarm(uint8_t i, int8_t tmin, int8_t tmax) {
+	uint8_t data[3];
+
+	if (i >= _count || tmin > tmax) {
+		setError(ERROR_OUT_OF_RANGE);
+		return false;
+	}
+	// the configuration register is written too: keep the current one
+	if (_bus->execute_P(&txn_read_scratchpad, _roms[i], _scratchpad) != ERROR_NONE) {
+		setError(_bus->getError());
+		return false;
+	}
+	data[0] = (uint8_t)tmax;
+	data[1] = (uint8_t)tmin;
+	data[2] = _scratchpad[CONFIGURATION];
+	if (_bus->execute_P(_roms[i][0] == FAM_CODE_DB18S20 ? &txn_write_alarms : &txn_write_scratchpad, _roms[i], data)
+		!= ERROR_NONE) {
+		setError(_bus->getError());
+		return false;
+	}
+	return true;
+}
+
+bool DS18B20fleet::setAlarms(int8_t tmin, int8_t tmax) {
+	bool ok = true;
+
+	for (uint8_t i = 0; i < _count; i++)
+		ok = setAlarm(i, tmin, tmax) && ok;
+	return ok;
+}
+
+uint8_t DS18B20fleet::poll(void) {
+	uint8_t rom[8], i, n = 0;
+	int16_t raw;
+
+	if (!convert())
+		return 0;
+
+	_bus->reset_search();
+	while (_bus->search(rom, CMD_ALARM_SEARCH)) {
+		if ((rom[0] != FAM_CODE_DB18B20 && rom[0] != FAM_CODE_DB18S20) || OWcomponent::crc8(rom, 7) != rom[7])
+			continue;
+		// known sensors get the checked read, see DS18B20group::read()
+		i = indexOf(rom);
+		if (i != 0xFF) {
+			if (read(i, &raw, false) != ERROR_NONE)
+				continue;
+		}
+		else if (_bus->execute_P(&txn_read_scratchpad, rom, _scratchpad) != ERROR_NONE) {
+			setError(_bus->getError());
+			continue;
+		}
+		else
+			raw = DS18B20::scratchpadToRaw(_scratchpad, rom[0]);
+		n++;
+		if (_handler)
+			_handler(i, rom, raw);
+	}
+	return n;
+}
@@ -0,0 +1,92 @@
+/**
+ \file DS18B20fleet.h
+ \brief Definition of the DS18B20fleet class.
+ \details Header file containing the definition of the DS18B20fleet class (alarm monitoring of many DS18B20 on one bus).
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef DS18B20FLEET_H
+#define DS18B20FLEET_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "DS18B20group.h"
+
+/**
+ \typedef void (*DS18B20alarmHandler)(uint8_t index, uint8_t rom[8], int16_t raw)
+ \brief Function called by \c DS18B20fleet::poll() for each sensor in alarm.
+ @param index Index of the sensor in the fleet, \c 0xFF if it is not part of it (the table was full).
+ @param rom Address of the sensor.
+ @param raw Temperature read, in 1/16 of Celsius degree.
+ */
+typedef void (*DS18B20alarmHandler)(uint8_t index, uint8_t rom[8], int16_t raw);
+
+/**
+ \class DS18B20fleet DS18B20fleet.h
+ \brief Monitors the alarms of all the DS18B20 on a 1-Wire bus.
+
+ The alarm bounds are programmed in the scratchpad of each sensor. A monitoring cycle then costs one broadcast
+ conversion and one alarm search: only the sensors whose temperature is out of their bounds answer the search,
+ and only these are read. When all the temperatures are in range the search fails at the first bit.
+ \remark The bounds are lost when a sensor is powered off, unless they are copied to its EEPROM.
+ */
+
+class DS18B20fleet : public DS18B20group {
+private:
+	DS18B20alarmHandler _handler;
+
+public:
+	/**
+	 \fn DS18B20fleet(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max)
+	 \brief Constructor
+	 @param bus Bus the sensors are on.
+	 @param roms Table receiving the addresses of the sensors.
+	 @param max Number of entries of \c roms.
+	 */
+	DS18B20fleet(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max);
+
+	/**
+	 \fn bool setAlarm(uint8_t i, int8_t tmin, int8_t tmax)
+	 \brief Programs the alarm bounds of the \c i-th sensor.
+	 \details The sensor is in alarm when its temperature is lower or equal to \c tmin or greater or equal to \c tmax
+	 (only the integer part of the temperature is compared). The resolution of the sensor is left unchanged.
+	 @param i Index of the sensor.
+	 @param tmin Lower bound (in Celsius degrees).
+	 @param tmax Upper bound (in Celsius degrees).
+	 \return \c True if the bounds have been written, \c False otherwise.
+	 */
+	bool setAlarm(uint8_t i, int8_t tmin, int8_t tmax);
+	/**
+	 \fn bool setAlarms(int8_t tmin, int8_t tmax)
+	 \brief Programs the same alarm bounds in all the sensors. See \c setAlarm().
+	 \return \c True if all the sensors have been programmed, \c False otherwise.
+	 */
+	bool setAlarms(int8_t tmin, int8_t tmax);
+
+	/**
+	 \fn void onAlarm(DS18B20alarmHandler h)
+	 \brief Sets the function called for each sensor in alarm.
+	 */
+	inline void onAlarm(DS18B20alarmHandler h) { _handler = h; }
+
+	/**
+	 \fn uint8_t poll(void)
+	 \brief Performs a monitoring cycle: broadcast conversion, then alarm search.
+	 \details The temperature of each sensor answering the alarm search is read and passed to the alarm handler.
+	 \return The number of sensors in alarm.
+	 */
+	uint8_t poll(void);
+};
+
+#endif
@@ -0,0 +1,247 @@
+/**
+ \file DS18B20group.cpp
+ \brief Implementation of the DS18B20group class.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "DS18B20group.h"
+
+// Timings and counters of the i-th sensor
+#if ONEWIRE_STATS
+#define SENSOR_STATS(i) (_stats ? &_stats[i] : (DS18B20stats *)NULL)
+#define SENSOR_STAT_INC(i, field) do { if (_stats) _stats[i].field++; } while (0)
+#else
+#define SENSOR_STATS(i) ((DS18B20stats *)NULL)
+#define SENSOR_STAT_INC(i, field) ((void)0)
+#endif
+
+static const OWtransaction PROGMEM txn_read_scratchpad =
+	{ OW_TXN_RESET | OW_TXN_MATCH | OW_TXN_CRC8, 1, { CMD_READ_SCRATCHPAD }, 0, 9 };
+static const OWtransaction PROGMEM txn_read_temperature =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_READ_SCRATCHPAD }, 0, 2 };
+static const OWtransaction PROGMEM txn_convert =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_START_CONVERSION }, 0, 0 };
+static const OWtransaction PROGMEM txn_convert_all =
+	{ OW_TXN_RESET | OW_TXN_SKIP, 1, { CMD_START_CONVERSION }, 0, 0 };
+static const OWtransaction PROGMEM txn_read_power_supply_all =
+	{ OW_TXN_RESET | OW_TXN_SKIP, 1, { CMD_READ_POWER_SUPPLY }, 0, 0 };
+
+DS18B20group::DS18B20group(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max) {
+	_bus = &bus;
+	_roms = roms;
+	_max = max;
+	_count = 0;
+	_convTime = DS18B20_CONVERSION_TIME;
+	_convStart = 0;
+	_convEpoch = 0;
+	_converting = false;
+	_timedOut = false;
+	_parasite = false;
+	_fast = false;
+	_last = NULL;
+	_maxJump = DS18B20_MAX_JUMP;
+	_retries = DS18B20_RETRIES;
+	_stats = NULL;
+	_convIndex = 0xFF;
+}
+
+uint8_t DS18B20group::discover(void) {
+	_count = 0;
+	_bus->reset_search();
+	// both families go through the same reads, told apart by their address
+	while (_count < _max && _bus->search(_roms[_count], CMD_GENERIC_SEARCH)) {
+		if ((_roms[_count][0] == FAM_CODE_DB18B20 || _roms[_count][0] == FAM_CODE_DB18S20)
+			&& OWcomponent::crc8(_roms[_count], 7) == _roms[_count][7])
+			_count++;
+	}
+	_bus->reset_search();
+	setValidation(_last, _maxJump, _retries);
+	setStats(_stats);
+
+	// parasite powered sensors pull the bus low during the read slot
+	_parasite = false;
+	if (_bus->execute_P(&txn_read_power_supply_all) == ERROR_NONE)
+		_parasite = !_bus->read_bit();
+
+	return _count;
+}
+
+uint8_t DS18B20group::indexOf(const uint8_t rom[8]) {
+	uint8_t i;
+
+	for (i = 0; i < _count; i++)
+		if (!memcmp(_roms[i], rom, 8))
+			return i;
+	return 0xFF;
+}
+
+void DS18B20group::setValidation(int16_t *last, int16_t maxJump, uint8_t retries) {
+	uint8_t i;
+
+	_last = last;
+	_maxJump = maxJump;
+	_retries = retries;
+	if (_last)
+		for (i = 0; i < _max; i++)
+			_last[i] = DS18B20_NO_SAMPLE;
+}
+
+void DS18B20group::setStats(DS18B20stats *stats) {
+	_stats = stats;
+	if (_stats)
+		memset(_stats, 0, _max * sizeof(DS18B20stats));
+}
+
+bool DS18B20group::startConversion(uint8_t *rom) {
+	// a parasite powered sensor draws its current from the strong pullup,
+	// the others convert in parallel while the bus is held high
+	if (_bus->execute_P(rom ? &txn_convert : &txn_convert_all, rom, NULL, _parasite ? OW_TXN_PULLUP : 0)
+		!= ERROR_NONE) {
+		setError(_bus->getError());
+		return false;
+	}
+	if (_parasite)
+		_bus->strong_pullup(_convTime);
+	_convStart = millis();
+	_convEpoch = _bus->getEpoch();
+	_convIndex = rom ? indexOf(rom) : 0xFF;
+	_converting = true;
+	_timedOut = false;
+	return true;
+}
+
+bool DS18B20group::isConversionDone(void) {
+	uint8_t i;
+	uint16_t ms;
+
+	if (!_converting)
+		return true;
+
+	if (_parasite) {
+		if (_bus->pullup_active())
+			return false;
+	}
+	// the sensors answer the read slots until the next reset only, the
+	// bus reads 1 once all of them are done
+	else if (millis() - _convStart <= _convTime) {
+		if (_bus->getEpoch() != _convEpoch || !_bus->read_bit())
+			return false;
+	}
+	else if (_bus->getEpoch() == _convEpoch && !_bus->read_bit()) {
+		setError(ERROR_TIME_OUT);
+		_timedOut = true;
+	}
+
+	// a broadcast conversion is accounted to all the sensors
+	if (_stats) {
+		ms = millis() - _convStart;
+		for (i = 0; i < _count; i++)
+			if (_convIndex == 0xFF || _convIndex == i)
+				DS18B20::recordConversion(&_stats[i], ms);
+	}
+	_converting = false;
+	return true;
+}
+
+bool DS18B20group::convert(uint8_t *rom) {
+	if (!startConversion(rom))
+		return false;
+	while (!isConversionDone())
+		;
+	return !_timedOut;
+}
+
+uint16_t DS18B20group::read(uint8_t i, int16_t *raw, bool fast) {
+	int16_t last, suspect = DS18B20_NO_SAMPLE;
+	uint8_t n;
+	uint16_t e;
+
+	if (i >= _count)
+		return setError(ERROR_OUT_OF_RANGE);
+	// the scratchpad still holds the previous temperature
+	if (_timedOut && (_convIndex == 0xFF || _convIndex == i)) {
+		SENSOR_STAT_INC(i, failures);
+		return setError(ERROR_TIME_OUT);
+	}
+	last = _last ? _last[i] : DS18B20_NO_SAMPLE;
+	for (n = 0; ; n++) {
+		e = fetch(i, raw, fast);
+		if (e == ERROR_NONE)
+			e = DS18B20::checkReading(_scratchpad, fast ? 2 : 9, *raw, last, suspect, _maxJump);
+		if (e == ERROR_NONE || e == ERROR_NO_PRESENCE || e == ERROR_TIME_OUT || n >= _retries)
+			break;
+
+		// only this sensor is retried, with the CRC, after a new conversion
+		// if the value itself is suspicious
+		SENSOR_STAT_INC(i, retries);
+		fast = false;
+		if (e == ERROR_POWER_ON_RESET || e == ERROR_IMPLAUSIBLE_VALUE) {
+			SENSOR_STAT_INC(i, reconversions);
+			suspect = *raw;
+			if (!convert(_roms[i])) {
+				SENSOR_STAT_INC(i, failures);
+				return getError();
+			}
+		}
+	}
+	if (e != ERROR_NONE) {
+		SENSOR_STAT_INC(i, failures);
+		return setError(e);
+	}
+	if (_last)
+		_last[i] = *raw;
+	return ERROR_NONE;
+}
+
+uint16_t DS18B20group::fetch(uint8_t i, int16_t *raw, bool fast) {
+#if ONEWIRE_STATS
+	unsigned long t0 = micros();
+#endif
+	uint16_t e;
+
+	e = _bus->execute_P(fast ? &txn_read_temperature : &txn_read_scratchpad, _roms[i], _scratchpad);
+	// TEMP_LSB and TEMP_MSB only, the reset stops the sensor
+	if (fast && e == ERROR_NONE)
+		_bus->reset();
+#if ONEWIRE_STATS
+	DS18B20::recordRead(SENSOR_STATS(i), micros() - t0, _bus->getSelectTime(), e);
+#endif
+	if (e != ERROR_NONE)
+		return e;
+	if (fast) {
+		*raw = (int16_t)((_scratchpad[TEMP_MSB] << 8) | _scratchpad[TEMP_LSB]);
+		if (_roms[i][0] == FAM_CODE_DB18S20)
+			*raw *= 8;
+	}
+	else
+		*raw = DS18B20::scratchpadToRaw(_scratchpad, _roms[i][0]);
+	return ERROR_NONE;
+}
+
+uint8_t DS18B20group::readAll(int16_t *raw, uint16_t *status) {
+	uint8_t i, n = 0;
+	uint16_t e;
+
+	if (!convert()) {
+		if (status)
+			for (i = 0; i < _count; i++)
+				status[i] = getError();
+		return 0;
+	}
+
+	for (i = 0; i < _count; i++) {
+		e = read(i, &raw[i]);
+		if (status)
+			status[i] = e;
+		if (e == ERROR_NONE)
+			n++;
+	}
+	return n;
+}
@@ -0,0 +1,224 @@
+/**
+ \file DS18B20group.h
+ \brief Definition of the DS18B20group class.
+ \details Header file containing the definition of the DS18B20group class (broadcast conversion and batched read of
+ many DS18B20 on one bus).
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef DS18B20GROUP_H
+#define DS18B20GROUP_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "OWcomponent.h"
+#include "DS18B20.h"
+
+/**
+ \class DS18B20group DS18B20group.h
+ \brief Reads all the DS18B20 and DS18S20 on a 1-Wire bus in one cycle.
+
+ A single SKIP ROM + Convert T starts the conversion of all the sensors at once, so that a cycle costs one
+ conversion time whatever the number of sensors, plus about 15 ms (standard speed) for reading each scratchpad.
+ When all the sensors are externally powered, the end of the conversion is detected with read slots: the bus
+ reads 0 as long as one of them is still busy.
+ */
+
+class DS18B20group : public Error {
+protected:
+	/**
+	 \var OWcomponent *_bus
+	 \brief Bus (or backend) the sensors are on.
+	 */
+	OWcomponent *_bus;
+	/**
+	 \var uint8_t (*_roms)[8]
+	 \brief Addresses of the sensors, the storage is provided by the caller.
+	 */
+	uint8_t (*_roms)[8];
+	uint8_t _max, _count;
+	uint16_t _convTime;
+	unsigned long _convStart;
+	uint8_t _convEpoch;
+	bool _converting;
+	/**
+	 \var bool _timedOut
+	 \brief \c True if the last conversion did not end in time: the sensors it was started on hold a stale value.
+	 */
+	bool _timedOut;
+	bool _parasite;
+	bool _fast;
+	/**
+	 \var int16_t *_last
+	 \brief Last reading accepted for each sensor, the storage is provided by the caller (\c NULL if none).
+	 */
+	int16_t *_last;
+	int16_t _maxJump;
+	uint8_t _retries;
+	/**
+	 \var DS18B20stats *_stats
+	 \brief Timings and counters of each sensor, the storage is provided by the caller (\c NULL if none).
+	 */
+	DS18B20stats *_stats;
+	// sensor converting alone, 0xFF for all of them
+	uint8_t _convIndex;
+	uint8_t _scratchpad[9];
+
+	/**
+	 \fn uint16_t fetch(uint8_t i, int16_t *raw, bool fast)
+	 \brief Reads the temperature held in the scratchpad of the \c i-th sensor once, see \c read().
+	 \return \c ERROR_NONE or the error code, which is not raised.
+	 */
+	uint16_t fetch(uint8_t i, int16_t *raw, bool fast);
+
+public:
+	/**
+	 \fn DS18B20group(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max)
+	 \brief Constructor
+	 @param bus Bus the sensors are on.
+	 @param roms Table receiving the addresses of the sensors.
+	 @param max Number of entries of \c roms.
+	 */
+	DS18B20group(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max);
+
+	/**
+	 \fn uint8_t discover(void)
+	 \brief Looks for all the DS18B20 and DS18S20 on the bus and checks if some of them are parasite powered.
+	 \details Both kinds can be mixed: the family code kept in the address of each sensor selects how its
+	 temperature is computed.
+	 \return The number of sensors found (at most the size of the table).
+	 */
+	uint8_t discover(void);
+	/**
+	 \fn uint8_t getCount(void)
+	 \brief Returns the number of sensors found by \c discover().
+	 */
+	inline uint8_t getCount(void) { return _count; }
+	/**
+	 \fn uint8_t *getAddress(uint8_t i)
+	 \brief Returns the address of the \c i-th sensor.
+	 */
+	inline uint8_t *getAddress(uint8_t i) { return _roms[i]; }
+	/**
+	 \fn uint8_t indexOf(const uint8_t rom[8])
+	 \brief Returns the index of the sensor having address \c rom, \c 0xFF if it is not part of the group.
+	 */
+	uint8_t indexOf(const uint8_t rom[8]);
+
+	/**
+	 \fn void setConversionTime(uint16_t ms)
+	 \brief Sets the longest time to wait after a conversion request (\c DS18B20_CONVERSION_TIME by default).
+	 \remark Use 94, 188 or 375 ms if all the sensors are set to 9, 10 or 11 bits.
+	 */
+	inline void setConversionTime(uint16_t ms) { _convTime = ms; }
+	/**
+	 \fn bool isParasiteMode(void)
+	 \brief Returns \c True if at least one sensor is parasite powered.
+	 */
+	inline bool isParasiteMode(void) { return _parasite; }
+
+	/**
+	 \fn bool startConversion(uint8_t *rom = NULL)
+	 \brief Starts a conversion on all the sensors at once and returns.
+	 \details If some sensors are parasite powered, the strong pullup is held for the conversion time and the
+	 bus is not usable until \c isConversionDone() returns \c True.
+	 @param rom Address of the only sensor to start, \c NULL for all of them.
+	 \return \c True if the conversion has been started, \c False otherwise.
+	 */
+	bool startConversion(uint8_t *rom = NULL);
+	/**
+	 \fn bool isConversionDone(void)
+	 \brief Returns \c True when the conversion started by \c startConversion() is over.
+	 \details Without parasite powered sensors the bus is asked with a read slot, unless it has been reset since
+	 \c startConversion(). If the sensors are still busy after the conversion time, \c ERROR_TIME_OUT is raised
+	 and \c True is returned: the sensors of this conversion then read \c ERROR_TIME_OUT until the next one.
+	 */
+	bool isConversionDone(void);
+	/**
+	 \fn bool convert(uint8_t *rom = NULL)
+	 \brief Starts a conversion on all the sensors at once (or on the sensor having address \c rom) and waits until
+	 it is done.
+	 \return \c True if the conversion has been done, \c False otherwise (it could not be started or it timed out).
+	 */
+	bool convert(uint8_t *rom = NULL);
+
+	/**
+	 \fn void setValidation(int16_t *last, int16_t maxJump = DS18B20_MAX_JUMP, uint8_t retries = DS18B20_RETRIES)
+	 \brief Sets how the readings are checked, see \c DS18B20::checkReading().
+	 @param last Table receiving the last reading accepted for each sensor (as many entries as the table of
+	 addresses), to reject the jumps. \c NULL only rejects the bad frames and the power-on value.
+	 @param maxJump Change since the previous reading, in 1/16 of Celsius degree, above which a new conversion is
+	 asked to confirm the value.
+	 @param retries Number of retries of a rejected reading before giving up, \c 0 reports every rejected reading
+	 as an error.
+	 \remark The table is cleared here and by \c discover().
+	 */
+	void setValidation(int16_t *last, int16_t maxJump = DS18B20_MAX_JUMP, uint8_t retries = DS18B20_RETRIES);
+
+	/**
+	 \fn void setStats(DS18B20stats *stats)
+	 \brief Keeps the timings and counters of each sensor in \c stats, see \c DS18B20stats.
+	 \details A broadcast conversion is accounted to all the sensors. With the counters of the bus
+	 (\c OWcomponent::getStats()) they tell which of the resolution, the addressing mode or the bus layout costs the
+	 most.
+	 @param stats Table with as many entries as the table of addresses, \c NULL to stop.
+	 \remark The table is cleared here and by \c discover(). It stays at 0 if \c ONEWIRE_STATS is defined to 0.
+	 */
+	void setStats(DS18B20stats *stats);
+
+	/**
+	 \fn void setFastRead(bool f)
+	 \brief Selects how the temperatures are read by default: only the two temperature bytes (\c True) or the
+	 whole scratchpad with CRC check (\c False, the default). See \c read().
+	 */
+	inline void setFastRead(bool f) { _fast = f; }
+	/**
+	 \fn bool isFastRead(void)
+	 \brief Returns \c True if the temperatures are read without the CRC by default.
+	 */
+	inline bool isFastRead(void) { return _fast; }
+
+	/**
+	 \fn uint16_t read(uint8_t i, int16_t *raw, bool fast)
+	 \brief Reads the result of the last conversion of the \c i-th sensor.
+	 @param i Index of the sensor.
+	 @param raw Receives the temperature, in 1/16 of Celsius degree (the bits below the resolution of the sensor
+	 are undefined). The temperature of a DS18S20 is extended to 1/16°C, except by a fast read (0.5°C steps).
+	 @param fast If \c True only the two temperature bytes are read, then the transfer is aborted by a reset: this
+	 saves 56 read slots but the CRC cannot be checked. Otherwise the whole scratchpad is read and its CRC is
+	 checked.
+	 \details Each reading is checked, see \c setValidation(). A rejected one is retried for this sensor only, with
+	 the whole scratchpad; when the value itself is suspicious (power-on value, jump) this sensor alone converts
+	 again first.
+	 \return \c ERROR_NONE if the temperature has been read, the error code otherwise (\c ERROR_NO_PRESENCE,
+	 \c ERROR_TIME_OUT, \c ERROR_INVALID_CRC, \c ERROR_OUT_OF_RANGE, \c ERROR_READ_FAILURE, \c ERROR_POWER_ON_RESET,
+	 \c ERROR_IMPLAUSIBLE_VALUE). The error is raised too.
+	 */
+	uint16_t read(uint8_t i, int16_t *raw, bool fast);
+	/**
+	 \fn uint16_t read(uint8_t i, int16_t *raw)
+	 \brief Same as above, the kind of read is chosen by \c setFastRead().
+	 */
+	inline uint16_t read(uint8_t i, int16_t *raw) { return read(i, raw, _fast); }
+	/**
+	 \fn uint8_t readAll(int16_t *raw, uint16_t *status = NULL)
+	 \brief Performs a complete cycle: broadcast conversion, then one read per sensor.
+	 @param raw Receives the temperature of each sensor, in 1/16 of Celsius degree (\c getCount() entries).
+	 @param status If not \c NULL, receives the result of each read (see \c read()).
+	 \return The number of sensors read correctly.
+	 */
+	uint8_t readAll(int16_t *raw, uint16_t *status = NULL);
+};
+
+#endif
@@ -29,17 +29,20 @@
  The user is allowed to set an alarm which will be triggered whenever the temperature goes below \c _alarm_tmin
  or higher than \c _alarm_tmax. These bounds can be set using \c setAlarm function. Their range
  must be contained in the operating range of the component i.e. between -25°C and +125°C.
+ All the work is done by the \c DS18B20 class, which recognizes the family code of the component: the
+ temperatures are extended to 1/16°C with the COUNT_REMAIN and COUNT_PER_C registers, in fixed point.
+ @see DS18B20::isDS18S20
  */
 
 
 #ifndef DS18S20_H
 #define DS18S20_H
 
-#include "DB18B20.h"
+#include "DS18B20.h"
 
 /* Sensor library
  
- DS18S20.H: class for temperature sensor DS18B20
+ DS18S20.H: class for temperature sensor DS18S20
 
 written by Enrico Formenti
 */
@@ -47,32 +50,19 @@ written by Enrico Formenti
 class DS18S20: public DS18B20 {  
 public:
 	/**
-	 \fn DS18B20(uint8_t p) : Sensor(S_DS18B20,ST_TEMPERATURE)  : OWcomponent(p)
+	 \fn DS18S20(uint8_t p) : DS18B20(S_DS18S20, p)
 	 \brief Constructor
-	 @param p The Arduino pin to which the data pin of DS18B20 is connected to.
+	 @param p The Arduino pin to which the data pin of DS18S20 is connected to.
 	 */
-	inline DS18S20(uint8_t p) : DS18B20(p) { };
+	inline DS18S20(uint8_t p) : DS18B20(S_DS18S20, p) { };
+	using DS18B20::begin;
 	/**
-	 \fn uint8_t getResolution(void)
-	 \brief Returns the resolution of the temperature value.
-	 \return Number of bits of resolution for the temperature value. For this model it is fixed to 9
-	 \remark This number should be multiplied by the basic step value (1/8) to get the actual approximation.
-	 @see setResolution
-	 */	
-	inline uint8_t getResolution(void) { return 9; };
-	/**
-	 \fn uint8_t setResolution(uint8_t r)
-	 \brief Sets the resolution of the temperature value.
-	 \return r Number of bits of resolution for the temperature value. This instruction has no effect for this version of
-	 the component since resolution bits is fixed to 9
-	 @see getResolution
-	 */	
-	inline setResolution(uint8_t r) { }
-	/**
-	 \fn float getTemperature(void)
-	 \brief Returns the temperature in Celsius degrees.
+	 \fn void begin(void)
+	 \brief Initializes the component internals. In particular, it obtains the address of the first DS18S20 on the
+	 1-Wire bus.
+	 \remark \c begin(uint8_t) is still available, e.g. to take a component of any family.
 	 */
-	float getTemperature(void) { return (float)((_scratchpad[TEMP_MSB]) << 8) | _scratchpad[TEMP_LSB]) >> 1) - 0.25 +((float)(scratchpad[COUNT_PER_C] - scratchpad[COUNT_REMAIN]) / (float)scratchpad[COUNT_PER_C] );}
+	inline void begin(void) { DS18B20::begin(FAM_CODE_DB18S20); }
 };
 
 #endif
@@ -0,0 +1,178 @@
+/**
+ \file DS2482.cpp
+ \brief Implementation of the DS2482 class.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "DS2482.h"
+
+// Channel selection codes, and the values read back once selected
+static const uint8_t channel_code[8] = { 0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87 };
+static const uint8_t channel_ack[8] = { 0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87 };
+
+// Number of status polls before giving up (a reset takes about 1.2 ms,
+// each poll about 0.1 ms at 100 kHz)
+#define DS2482_POLL_LIMIT 100
+
+uint8_t DS2482::waitIdle(void) {
+	uint8_t status;
+	uint8_t polls = DS2482_POLL_LIMIT;
+
+	// the other commands leave the read pointer on the register they wrote
+	if (_pointer != DS2482_REG_STATUS) {
+		writeByte(DS2482_CMD_SET_READ_POINTER, DS2482_REG_STATUS);
+		_pointer = DS2482_REG_STATUS;
+	}
+	do {
+		status = readByte();
+	} while ((status & DS2482_STATUS_1WB) && --polls);
+
+	if (status & DS2482_STATUS_1WB)
+		setError(ERROR_TIME_OUT);
+
+	return status;
+}
+
+void DS2482::command(uint8_t cmd) {
+
+	writeCommand(cmd);
+	// the bridge moves the read pointer to the status register
+	_pointer = DS2482_REG_STATUS;
+	// and ends the strong pullup, clearing SPU
+	_spu = false;
+}
+
+void DS2482::command(uint8_t cmd, uint8_t param) {
+
+	writeByte(cmd, param);
+	_pointer = DS2482_REG_STATUS;
+	_spu = false;
+}
+
+void DS2482::writeConfig(uint8_t c) {
+	// upper nibble must be the one's complement of the lower one
+	writeByte(DS2482_CMD_WRITE_CONFIG, (uint8_t)((c & 0x0F) | ((~c) << 4)));
+	_pointer = DS2482_REG_CONFIG;
+	// writing SPU at 0 ends the strong pullup too
+	_config = c & ~DS2482_CONFIG_SPU;
+	_spu = (c & DS2482_CONFIG_SPU) != 0;
+}
+
+bool DS2482::begin(void) {
+
+	writeCommand(DS2482_CMD_DEVICE_RESET);
+	_pointer = DS2482_REG_STATUS;
+	if (!(readByte() & DS2482_STATUS_RST)) {
+		setError(ERROR_READ_FAILURE);
+		return false;
+	}
+	writeConfig(DS2482_CONFIG_APU);
+	_channel = 0;
+	reset_bus_state();
+
+	return true;
+}
+
+bool DS2482::selectChannel(uint8_t ch) {
+
+	if (ch > 7) {
+		setError(ERROR_OUT_OF_RANGE);
+		return false;
+	}
+	writeByte(DS2482_CMD_CHANNEL_SELECT, channel_code[ch]);
+	_pointer = DS2482_REG_CHANNEL;
+	if (readByte() != channel_ack[ch]) {
+		setError(ERROR_WRITE_FAILURE);
+		return false;
+	}
+	_channel = ch;
+	reset_bus_state();
+
+	return true;
+}
+
+uint8_t DS2482::bus_reset(void) {
+	uint8_t status;
+
+	waitIdle();
+	command(DS2482_CMD_1WIRE_RESET);
+	status = waitIdle();
+
+	if (status & DS2482_STATUS_SD) {
+		count_short();
+		return 0;
+	}
+
+	return (status & DS2482_STATUS_PPD) ? 1 : 0;
+}
+
+void DS2482::bus_write_bit(uint8_t v) {
+
+	waitIdle();
+	command(DS2482_CMD_1WIRE_SINGLE_BIT, v ? 0x80 : 0x00);
+}
+
+uint8_t DS2482::bus_read_bit(void) {
+
+	waitIdle();
+	command(DS2482_CMD_1WIRE_SINGLE_BIT, 0x80);
+
+	return (waitIdle() & DS2482_STATUS_SBR) ? 1 : 0;
+}
+
+void DS2482::bus_write(uint8_t v, uint8_t power) {
+
+	waitIdle();
+	// the strong pullup starts at the end of the next byte
+	if (power)
+		writeConfig(_config | DS2482_CONFIG_SPU);
+	command(DS2482_CMD_1WIRE_WRITE_BYTE, v);
+	_spu = power;
+}
+
+uint8_t DS2482::bus_read(void) {
+
+	waitIdle();
+	command(DS2482_CMD_1WIRE_READ_BYTE);
+	waitIdle();
+	writeByte(DS2482_CMD_SET_READ_POINTER, DS2482_REG_DATA);
+	_pointer = DS2482_REG_DATA;
+
+	return readByte();
+}
+
+void DS2482::bus_depower(void) {
+
+	if (_spu) {
+		waitIdle();
+		writeConfig(_config);
+	}
+}
+
+uint8_t DS2482::bus_triplet(uint8_t direction) {
+	uint8_t status;
+
+	waitIdle();
+	command(DS2482_CMD_1WIRE_TRIPLET, direction ? 0x80 : 0x00);
+	status = waitIdle();
+
+	return ((status & DS2482_STATUS_SBR) ? 0x01 : 0) |
+	       ((status & DS2482_STATUS_TSB) ? 0x02 : 0) |
+	       ((status & DS2482_STATUS_DIR) ? 0x04 : 0);
+}
+
+void DS2482::bus_speed(uint8_t speed) {
+
+	waitIdle();
+	if (speed == OW_SPEED_OVERDRIVE)
+		writeConfig(_config | DS2482_CONFIG_1WS);
+	else
+		writeConfig(_config & ~DS2482_CONFIG_1WS);
+}
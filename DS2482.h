@@ -0,0 +1,181 @@
+/**
+ \file DS2482.h
+ \brief Definition of the DS2482 class.
+ \details Header file containing the definition of the DS2482 class (I2C to 1-Wire bridge).
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef DS2482_H
+#define DS2482_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "OWcomponent.h"
+#include "I2Ccomponent.h"
+
+/**
+ \name DS2482 commands
+ \brief Macro definitions for the commands of the DS2482.
+ */
+//@{
+#define DS2482_CMD_DEVICE_RESET 0xF0
+#define DS2482_CMD_SET_READ_POINTER 0xE1
+#define DS2482_CMD_WRITE_CONFIG 0xD2
+#define DS2482_CMD_CHANNEL_SELECT 0xC3
+#define DS2482_CMD_1WIRE_RESET 0xB4
+#define DS2482_CMD_1WIRE_SINGLE_BIT 0x87
+#define DS2482_CMD_1WIRE_WRITE_BYTE 0xA5
+#define DS2482_CMD_1WIRE_READ_BYTE 0x96
+#define DS2482_CMD_1WIRE_TRIPLET 0x78
+//@}
+
+/**
+ \name DS2482 registers
+ \brief Macro definitions for the read pointer codes of the DS2482 registers.
+ */
+//@{
+#define DS2482_REG_STATUS 0xF0
+#define DS2482_REG_DATA 0xE1
+#define DS2482_REG_CHANNEL 0xD2
+#define DS2482_REG_CONFIG 0xC3
+//@}
+
+/**
+ \name DS2482 status and configuration bits
+ */
+//@{
+#define DS2482_STATUS_1WB 0x01
+#define DS2482_STATUS_PPD 0x02
+#define DS2482_STATUS_SD 0x04
+#define DS2482_STATUS_LL 0x08
+#define DS2482_STATUS_RST 0x10
+#define DS2482_STATUS_SBR 0x20
+#define DS2482_STATUS_TSB 0x40
+#define DS2482_STATUS_DIR 0x80
+
+#define DS2482_CONFIG_APU 0x01
+#define DS2482_CONFIG_SPU 0x04
+#define DS2482_CONFIG_1WS 0x08
+//@}
+
+/**
+ \def DS2482_ADDRESS 0x18
+ \brief I2C address of a DS2482 having both AD0 and AD1 pins tied to ground.
+ */
+#define DS2482_ADDRESS 0x18
+
+/**
+ \class DS2482 DS2482.h
+ \brief 1-Wire bus driven by a DS2482-100 or DS2482-800 I2C bridge.
+
+ This class implements the \c OWcomponent primitives with the commands of the bridge, so that all the
+ 1-Wire timings are generated in hardware and interrupts are never disabled. The search algorithm uses the
+ triplet command of the bridge, and the strong pullup (\c power parameter of \c write()) uses its SPU feature.
+ */
+
+/**
+ \example DS2482scan/DS2482scan.ino
+ This gives an example of usage of a DS2482-800 to list the devices of its eight 1-Wire buses.
+ */
+
+class DS2482 : public OWcomponent, public I2Ccomponent {
+private:
+	/**
+	 \var uint8_t _config
+	 \brief Current value of the configuration register, SPU excepted.
+	 \details The bridge clears SPU by itself when the strong pullup ends: it is only ever sent with the powered
+	 byte, never kept here.
+	 */
+	uint8_t _config;
+	/**
+	 \var bool _spu
+	 \brief \c True if the strong pullup may still be on, until the next 1-Wire command or \c bus_depower().
+	 */
+	bool _spu;
+	/**
+	 \var uint8_t _channel
+	 \brief Channel currently selected (always 0 for a DS2482-100).
+	 */
+	uint8_t _channel;
+	/**
+	 \var uint8_t _pointer
+	 \brief Register the read pointer of the bridge is on (\c 0 if unknown).
+	 \details The bridge moves it to the status register after each 1-Wire command, and to the register written
+	 by the other commands.
+	 */
+	uint8_t _pointer;
+
+	/**
+	 \fn uint8_t waitIdle(void)
+	 \brief Waits until the 1-Wire command in progress is over.
+	 \details The read pointer is moved back to the status register first if needed.
+	 \return The status register. \c ERROR_TIME_OUT is raised if the bridge stays busy.
+	 */
+	uint8_t waitIdle(void);
+	/**
+	 \fn void command(uint8_t cmd)
+	 \brief Sends a 1-Wire command without parameter to the bridge.
+	 */
+	void command(uint8_t cmd);
+	/**
+	 \fn void command(uint8_t cmd, uint8_t param)
+	 \brief Sends a 1-Wire command and its parameter byte to the bridge.
+	 */
+	void command(uint8_t cmd, uint8_t param);
+	/**
+	 \fn void writeConfig(uint8_t c)
+	 \brief Writes the configuration register. SPU is written if set in \c c but not kept in \c _config.
+	 */
+	void writeConfig(uint8_t c);
+
+protected:
+	uint8_t bus_reset(void);
+	void bus_write_bit(uint8_t v);
+	uint8_t bus_read_bit(void);
+	void bus_write(uint8_t v, uint8_t power);
+	uint8_t bus_read(void);
+	void bus_depower(void);
+	uint8_t bus_triplet(uint8_t direction);
+	void bus_speed(uint8_t speed);
+
+public:
+	/**
+	 \fn DS2482(const uint8_t a = DS2482_ADDRESS)
+	 \brief Constructor
+	 @param a Address of the bridge on the I2C bus.
+	 */
+	inline DS2482(const uint8_t a = DS2482_ADDRESS) : OWcomponent(), I2Ccomponent(a) { _config = DS2482_CONFIG_APU; _spu = false; _channel = 0; _pointer = 0; }
+	/**
+	 \fn bool begin(void)
+	 \brief Resets the bridge and configures it (active pullup on).
+	 \return \c True if the bridge answered, \c False otherwise.
+	 */
+	bool begin(void);
+	/**
+	 \fn bool selectChannel(uint8_t ch)
+	 \brief Selects the 1-Wire bus to drive (DS2482-800 only).
+	 @param ch Channel (from 0 to 7).
+	 \return \c True if the channel has been selected, \c False otherwise.
+	 \remark The search state, the device count and the RESUME target are forgotten since they refer to
+	 the previous bus.
+	 */
+	bool selectChannel(uint8_t ch);
+	/**
+	 \fn uint8_t getChannel(void)
+	 \brief Returns the channel currently selected.
+	 */
+	inline uint8_t getChannel(void) { return _channel; }
+};
+
+#endif
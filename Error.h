@@ -60,6 +60,11 @@
  \brief Signals that the value obtained or passed as parameter is out of allowed range. 
  */
 #define ERROR_OUT_OF_RANGE 0x5437
+/**
+ \def ERROR_NO_PRESENCE 0x3d1c
+ \brief Signals that no device answered a bus reset (1-Wire components).
+ */
+#define ERROR_NO_PRESENCE 0x3d1c
 /**
  \def ERROR_INVALID_DATA 0xae92d210
  \brief Signals that invalid data has been detected. 
@@ -70,6 +75,22 @@
  \brief Signals that the data has not the expected format/structure. 
  */
 #define ERROR_INVALID_FORMAT 0xa67ea6fe
+/**
+ \def ERROR_POWER_ON_RESET 0x7e21
+ \brief Signals that a component returned its power-on value instead of a measure (it has been reset by a
+ brownout, for example).
+ */
+#define ERROR_POWER_ON_RESET 0x7e21
+/**
+ \def ERROR_IMPLAUSIBLE_VALUE 0x19c4
+ \brief Signals that a measure differs too much from the previous one to be trusted.
+ */
+#define ERROR_IMPLAUSIBLE_VALUE 0x19c4
+/**
+ \def ERROR_NOT_SUPPORTED 0x8b3f
+ \brief Signals that the hardware cannot perform the operation requested.
+ */
+#define ERROR_NOT_SUPPORTED 0x8b3f
 //@}
 
 /**
@@ -118,8 +139,9 @@ public:
 	 \fn uint8_t setError(uint16_t e)
 	 \brief Sets the code for the error just occurred (or \c ERROR_NONE for no errors for resetting error status).
 	 @param e Code of error that has occurred.
+	 \return The code \c e, so that the error can be raised and returned in one statement.
 	 */	
-	inline uint16_t setError(uint16_t e) { _error = e; }
+	inline uint16_t setError(uint16_t e) { return (_error = e); }
 	/**
 	 \fn bool hasErrorOccurred(void)
 	 \brief Returns \c True if an error has occurred, \c False otherwise.
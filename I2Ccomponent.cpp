@@ -45,3 +45,19 @@ uint8_t I2Ccomponent::readByte(const uint8_t adr) {
 	
 	return data;
 }
+
+void I2Ccomponent::writeCommand(const uint8_t cmd) {
+
+	Wire.beginTransmission(_address);
+	Wire.write(cmd);
+	Wire.endTransmission();
+}
+
+uint8_t I2Ccomponent::readByte(void) {
+	uint8_t data = 0xFF;
+
+	Wire.requestFrom((uint8_t)_address,(uint8_t)1);
+	while (Wire.available()) data=Wire.read();
+
+	return data;
+}
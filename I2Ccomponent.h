@@ -56,6 +56,18 @@ protected:
 	 for this component.
 	 */	
 	void writeByte(const uint8_t adr, const uint8_t data);
+	/**
+	 \fn void writeCommand(const uint8_t cmd)
+	 \brief Sends a single byte (a command with no parameter) to the component via the I2C bus.
+	 @param cmd Command to be sent.
+	 */
+	void writeCommand(const uint8_t cmd);
+	/**
+	 \fn uint8_t readByte(void)
+	 \brief Reads a byte from the component without sending any address first.
+	 \details This is for components which keep an internal read pointer, set by a previous command.
+	 */
+	uint8_t readByte(void);
 public:	
 	/**
 	 \fn I2Ccomponent(const uint8_t a)
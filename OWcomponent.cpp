@@ -110,6 +110,38 @@ sample code bearing this copyright.
 */
 
 #include "OWcomponent.h"
+
+// Health counters
+#if ONEWIRE_STATS
+#define STAT_INC(field) (_stats.field++)
+#else
+#define STAT_INC(field) ((void)0)
+#endif
+
+// Time spent in the primitives and interrupts-disabled windows
+#if ONEWIRE_STATS && ONEWIRE_STATS_TIMING
+#define STAT_TIME_BEGIN() unsigned long t0 = micros()
+#define STAT_TIME_END() (_stats.busMicros += micros() - t0)
+#define IRQ_OFF() do { noInterrupts(); _irqStart = micros(); } while (0)
+#define IRQ_ON() do { \
+		unsigned long d = micros() - _irqStart; \
+		if (d > _stats.maxIrqOff) _stats.maxIrqOff = d; \
+		interrupts(); \
+	} while (0)
+#else
+#define STAT_TIME_BEGIN()
+#define STAT_TIME_END()
+#define IRQ_OFF() noInterrupts()
+#define IRQ_ON() interrupts()
+#endif
+
+// Slot timings for standard and overdrive speeds
+static const OWtiming PROGMEM timing_table[2] = {
+	// standard speed
+	{ 500, 80, 420, 10, 55, 65, 5, 3, 10, 53 },
+	// overdrive speed
+	{ 70, 9, 40, 1, 8, 8, 3, 1, 1, 7 }
+};
 /*
 boolean OWcomponent::isAlarmTriggered(void) {
   bool retval = false;
@@ -126,6 +158,27 @@ OWcomponent::OWcomponent(const uint8_t pin) {
 	pinMode(pin, INPUT);
 	bitmask = PIN_TO_BITMASK(pin);
 	baseReg = PIN_TO_BASEREG(pin);
+	init();
+}
+
+OWcomponent::OWcomponent(void) {
+	bitmask = 0;
+	baseReg = NULL;
+	init();
+}
+
+void OWcomponent::init(void) {
+	_addressing = OW_ADDRESSING_AUTO;
+	_devCount = 0;
+	_resumeValid = false;
+	memset(_lastRom, 0, sizeof(_lastRom));
+	_overdrive = false;
+	_calibrated = 0;
+	_pullup = false;
+	_epoch = 0;
+	memset(_adr, 0, sizeof(_adr));
+	setSpeed(OW_SPEED_STANDARD);
+	clearStats();
 #if ONEWIRE_SEARCH
 	reset_search();
 #endif
@@ -138,33 +191,36 @@ OWcomponent::OWcomponent(const uint8_t pin) {
 //
 // Returns 1 if a device asserted a presence pulse, 0 otherwise.
 //
-uint8_t OWcomponent::reset(void)
+uint8_t OWcomponent::bus_reset(void)
 {
 	IO_REG_TYPE mask = bitmask;
 	volatile IO_REG_TYPE *reg IO_REG_ASM = baseReg;
 	uint8_t r;
 	uint8_t retries = 125;
 
-	noInterrupts();
+	IRQ_OFF();
 	DIRECT_MODE_INPUT(reg, mask);
-	interrupts();
+	IRQ_ON();
 	// wait until the wire is high... just in case
 	do {
-		if (--retries == 0) return 0;
+		if (--retries == 0) {
+			count_short();
+			return 0;
+		}
 		delayMicroseconds(2);
 	} while ( !DIRECT_READ(reg, mask));
 
-	noInterrupts();
+	IRQ_OFF();
 	DIRECT_WRITE_LOW(reg, mask);
 	DIRECT_MODE_OUTPUT(reg, mask);	// drive output low
-	interrupts();
-	delayMicroseconds(500);
-	noInterrupts();
+	IRQ_ON();
+	delayMicroseconds(_timing.resetLow);
+	IRQ_OFF();
 	DIRECT_MODE_INPUT(reg, mask);	// allow it to float
-	delayMicroseconds(80);
+	delayMicroseconds(_timing.presenceSample);
 	r = !DIRECT_READ(reg, mask);
-	interrupts();
-	delayMicroseconds(420);
+	IRQ_ON();
+	delayMicroseconds(_timing.resetRecovery);
 	return r;
 }
 
@@ -172,27 +228,29 @@ uint8_t OWcomponent::reset(void)
 // Write a bit. Port and bit is used to cut lookup time and provide
 // more certain timing.
 //
-void OWcomponent::write_bit(uint8_t v)
+void OWcomponent::bus_write_bit(uint8_t v)
 {
 	IO_REG_TYPE mask=bitmask;
 	volatile IO_REG_TYPE *reg IO_REG_ASM = baseReg;
 
 	if (v & 1) {
-		noInterrupts();
+		uint8_t low = _timing.write1Low, recovery = _timing.write1Recovery;
+		IRQ_OFF();
 		DIRECT_WRITE_LOW(reg, mask);
 		DIRECT_MODE_OUTPUT(reg, mask);	// drive output low
-		delayMicroseconds(10);
+		delayMicroseconds(low);
 		DIRECT_WRITE_HIGH(reg, mask);	// drive output high
-		interrupts();
-		delayMicroseconds(55);
+		IRQ_ON();
+		delayMicroseconds(recovery);
 	} else {
-		noInterrupts();
+		uint8_t low = _timing.write0Low, recovery = _timing.write0Recovery;
+		IRQ_OFF();
 		DIRECT_WRITE_LOW(reg, mask);
 		DIRECT_MODE_OUTPUT(reg, mask);	// drive output low
-		delayMicroseconds(65);
+		delayMicroseconds(low);
 		DIRECT_WRITE_HIGH(reg, mask);	// drive output high
-		interrupts();
-		delayMicroseconds(5);
+		IRQ_ON();
+		delayMicroseconds(recovery);
 	}
 }
 
@@ -200,21 +258,22 @@ void OWcomponent::write_bit(uint8_t v)
 // Read a bit. Port and bit is used to cut lookup time and provide
 // more certain timing.
 //
-uint8_t OWcomponent::read_bit(void)
+uint8_t OWcomponent::bus_read_bit(void)
 {
 	IO_REG_TYPE mask=bitmask;
 	volatile IO_REG_TYPE *reg IO_REG_ASM = baseReg;
 	uint8_t r;
+	uint8_t low = _timing.readLow, sample = _timing.readSample;
 
-	noInterrupts();
+	IRQ_OFF();
 	DIRECT_MODE_OUTPUT(reg, mask);
 	DIRECT_WRITE_LOW(reg, mask);
-	delayMicroseconds(3);
+	delayMicroseconds(low);
 	DIRECT_MODE_INPUT(reg, mask);	// let pin float, pull up will raise
-	delayMicroseconds(10);
+	delayMicroseconds(sample);
 	r = DIRECT_READ(reg, mask);
-	interrupts();
-	delayMicroseconds(53);
+	IRQ_ON();
+	delayMicroseconds(_timing.readRecovery);
 	return r;
 }
 
@@ -225,40 +284,36 @@ uint8_t OWcomponent::read_bit(void)
 // go tri-state at the end of the write to avoid heating in a short or
 // other mishap.
 //
-void OWcomponent::write(uint8_t v, uint8_t power /* = 0 */) {
+void OWcomponent::bus_write(uint8_t v, uint8_t power) {
     uint8_t bitMask;
 
     for (bitMask = 0x01; bitMask; bitMask <<= 1) {
-	OWcomponent::write_bit( (bitMask & v)?1:0);
+	OWcomponent::bus_write_bit( (bitMask & v)?1:0);
     }
     if ( !power) {
-	noInterrupts();
+	IRQ_OFF();
 	DIRECT_MODE_INPUT(baseReg, bitmask);
 	DIRECT_WRITE_LOW(baseReg, bitmask);
-	interrupts();
+	IRQ_ON();
     }
 }
 
 void OWcomponent::write_bytes(const uint8_t *buf, uint16_t count, bool power /* = 0 */) {
   for (uint16_t i = 0 ; i < count ; i++)
-    write(buf[i]);
-  if (!power) {
-    noInterrupts();
-    DIRECT_MODE_INPUT(baseReg, bitmask);
-    DIRECT_WRITE_LOW(baseReg, bitmask);
-    interrupts();
-  }
+    write(buf[i], power);
+  if (!power)
+    depower();
 }
 
 //
 // Read a byte
 //
-uint8_t OWcomponent::read() {
+uint8_t OWcomponent::bus_read() {
     uint8_t bitMask;
     uint8_t r = 0;
 
     for (bitMask = 0x01; bitMask; bitMask <<= 1) {
-	if ( OWcomponent::read_bit()) r |= bitMask;
+	if ( OWcomponent::bus_read_bit()) r |= bitMask;
     }
     return r;
 }
@@ -278,6 +333,10 @@ void OWcomponent::select( uint8_t rom[8])
     write(0x55);           // Choose ROM
 
     for( i = 0; i < 8; i++) write(rom[i]);
+
+    // the selected device is now the target of a RESUME command
+    for( i = 0; i < 8; i++) _lastRom[i] = rom[i];
+    _resumeValid = supportsResume(rom[0]);
 }
 
 //
@@ -286,13 +345,485 @@ void OWcomponent::select( uint8_t rom[8])
 void OWcomponent::skip()
 {
     write(0xCC);           // Skip ROM
+    _resumeValid = false;  // Skip ROM clears the RESUME flag of all devices
 }
 
-void OWcomponent::depower()
+//
+// Address a device using the cheapest ROM command allowed by the
+// addressing policy
+//
+void OWcomponent::address(uint8_t rom[8])
+{
+    uint8_t i;
+    bool same, od;
+
+    for (i = 0; i < 8 && rom[i] == _lastRom[i]; i++) ;
+    same = (i == 8);
+    od = _overdrive && supportsOverdrive(rom[0]);
+
+    // at overdrive speed only the devices switched to overdrive are
+    // listening: bring everybody back to standard speed otherwise
+    if (_speed == OW_SPEED_OVERDRIVE && !(_odAll ? od : same)) {
+        setSpeed(OW_SPEED_STANDARD);
+        reset();
+    }
+
+    if (_addressing == OW_ADDRESSING_AUTO) {
+        // only one device on the bus: no need to send its ROM
+        if (_devCount == 1) {
+            if (od && _speed == OW_SPEED_STANDARD)
+                overdrive_skip();
+            else
+                skip();
+            return;
+        }
+        // same device as last time: resume
+        if (_resumeValid && same) {
+            write(CMD_RESUME);
+            return;
+        }
+    }
+
+    if (od && _speed == OW_SPEED_STANDARD)
+        overdrive_select(rom);
+    else
+        select(rom);
+}
+
+//
+// Do an overdrive ROM skip
+//
+void OWcomponent::overdrive_skip()
+{
+    write(CMD_OVERDRIVE_SKIP);
+    setSpeed(OW_SPEED_OVERDRIVE);
+    _odAll = true;
+    _resumeValid = false;
+}
+
+//
+// Do an overdrive ROM select. The ROM is sent at overdrive speed.
+//
+void OWcomponent::overdrive_select(uint8_t rom[8])
 {
-	noInterrupts();
+    uint8_t i;
+
+    write(CMD_OVERDRIVE_MATCH);
+    setSpeed(OW_SPEED_OVERDRIVE);
+
+    for (i = 0; i < 8; i++) write(rom[i]);
+
+    for (i = 0; i < 8; i++) _lastRom[i] = rom[i];
+    _resumeValid = supportsResume(rom[0]);
+}
+
+void OWcomponent::setSpeed(uint8_t speed)
+{
+    if (speed != OW_SPEED_OVERDRIVE)
+        speed = OW_SPEED_STANDARD;
+    defaultTiming(speed, &_timing);
+    if (_calibrated & (1 << speed)) {
+        _timing.readSample = _calSample[speed];
+        _timing.readRecovery = _calRecovery[speed];
+    }
+    _speed = speed;
+    _odAll = false;
+    bus_speed(speed);
+}
+
+void OWcomponent::defaultTiming(uint8_t speed, OWtiming *t)
+{
+    if (speed != OW_SPEED_OVERDRIVE)
+        speed = OW_SPEED_STANDARD;
+    memcpy_P(t, &timing_table[speed], sizeof(OWtiming));
+}
+
+void OWcomponent::reset_bus_state(void)
+{
+    _devCount = 0;
+    _resumeValid = false;
+    _odAll = false;
+#if ONEWIRE_SEARCH
+    reset_search();
+#endif
+}
+
+bool OWcomponent::supportsOverdrive(uint8_t family)
+{
+    switch (family) {
+        case 0x0A:  // DS1995
+        case 0x0B:  // DS1985
+        case 0x0C:  // DS1996
+        case 0x0F:  // DS1986
+        case 0x1C:  // DS28E04
+        case 0x1D:  // DS2423
+        case 0x23:  // DS2433
+        case 0x29:  // DS2408
+        case 0x2D:  // DS2431
+        case 0x37:  // DS1977
+        case 0x3A:  // DS2413
+        case 0x42:  // DS28EA00
+        case 0x43:  // DS28EC20
+            return true;
+    }
+    return false;
+}
+
+bool OWcomponent::supportsResume(uint8_t family)
+{
+    switch (family) {
+        case 0x1C:  // DS28E04
+        case 0x29:  // DS2408
+        case 0x2D:  // DS2431
+        case 0x3A:  // DS2413
+        case 0x42:  // DS28EA00
+        case 0x43:  // DS28EC20
+            return true;
+    }
+    return false;
+}
+
+void OWcomponent::bus_depower()
+{
+	IRQ_OFF();
 	DIRECT_MODE_INPUT(baseReg, bitmask);
-	interrupts();
+	IRQ_ON();
+}
+
+//
+// One step of the search: read a bit and its complement, then write
+// the direction taken.
+//
+uint8_t OWcomponent::bus_triplet(uint8_t direction)
+{
+	uint8_t id_bit, cmp_id_bit;
+
+	id_bit = OWcomponent::bus_read_bit();
+	cmp_id_bit = OWcomponent::bus_read_bit();
+
+	// no devices on 1-wire
+	if (id_bit && cmp_id_bit)
+		return 0x03;
+
+	// all devices coupled have 0 or 1
+	if (id_bit != cmp_id_bit)
+		direction = id_bit;
+	OWcomponent::bus_write_bit(direction);
+
+	return id_bit | (cmp_id_bit << 1) | (direction << 2);
+}
+
+void OWcomponent::bus_speed(uint8_t /* speed */)
+{
+	// slot timings are all that the bit-banging code needs
+}
+
+#if ONEWIRE_CRC
+//
+// Read the ROM of a device 'tries' times with the current timings
+//
+bool OWcomponent::calibration_test(uint8_t *rom, uint8_t tries)
+{
+	uint8_t buf[8];
+
+	while (tries--) {
+#if ONEWIRE_SEARCH
+		if (rom) {
+			if (!verify(rom))
+				return false;
+			continue;
+		}
+#endif
+		if (!reset())
+			return false;
+		write(CMD_READ_ROM);
+		read_bytes(buf, 8);
+		// a shorted bus reads as all zeros, which has a valid CRC
+		if (!buf[0] || crc8(buf, 7) != buf[7])
+			return false;
+	}
+	return true;
+}
+
+bool OWcomponent::calibrate(uint8_t *rom, uint8_t tries)
+{
+	OWtiming saved = _timing, def;
+	uint8_t s, first = 0, len = 0, best = 0, bestLen = 0, slot, slotMin, maxSample;
+#if ONEWIRE_STATS
+	OWstats stats = _stats;
+#endif
+
+	slot = saved.readSample + saved.readRecovery;
+	maxSample = (_speed == OW_SPEED_OVERDRIVE) ? OW_CAL_SAMPLE_MAX_OD : OW_CAL_SAMPLE_MAX;
+	if (maxSample > slot)
+		maxSample = slot;
+
+	// widest window of good sample delays, same slot length as now
+	for (s = 0; s <= maxSample; s++) {
+		_timing.readSample = s;
+		_timing.readRecovery = slot - s;
+		if (calibration_test(rom, tries)) {
+			if (!len++)
+				first = s;
+			if (len > bestLen) {
+				bestLen = len;
+				best = first;
+			}
+		}
+		else
+			len = 0;
+	}
+
+	if (!bestLen) {
+		_timing = saved;
+#if ONEWIRE_STATS
+		_stats = stats;
+#endif
+		setError(ERROR_READ_FAILURE);
+		return false;
+	}
+	// widest margin on both sides of the sample point
+	_timing.readSample = best + (bestLen - 1) / 2;
+
+	// the devices need the whole slot and the recovery before the next one,
+	// and the default recovery recharges the line
+	defaultTiming(_speed, &def);
+	slotMin = (_speed == OW_SPEED_OVERDRIVE) ? OW_SLOT_MIN_OD : OW_SLOT_MIN;
+	_timing.readRecovery = slot - _timing.readSample;
+	if (_timing.readRecovery < def.readRecovery)
+		_timing.readRecovery = def.readRecovery;
+	if (_timing.readLow + _timing.readSample + _timing.readRecovery < slotMin)
+		_timing.readRecovery = slotMin - _timing.readLow - _timing.readSample;
+
+	_calSample[_speed] = _timing.readSample;
+	_calRecovery[_speed] = _timing.readRecovery;
+	_calibrated |= (1 << _speed);
+#if ONEWIRE_STATS
+	_stats = stats;
+#endif
+	return true;
+}
+
+void OWcomponent::getCalibration(OWcalibration *c)
+{
+	c->speed = _speed;
+	c->readSample = _timing.readSample;
+	c->readRecovery = _timing.readRecovery;
+	c->crc = ~crc8((uint8_t *)c, 3);
+}
+
+bool OWcomponent::setCalibration(const OWcalibration *c)
+{
+	if ((uint8_t)~crc8((uint8_t *)c, 3) != c->crc || c->speed > OW_SPEED_OVERDRIVE) {
+		setError(ERROR_INVALID_CRC);
+		return false;
+	}
+	_calSample[c->speed] = c->readSample;
+	_calRecovery[c->speed] = c->readRecovery;
+	_calibrated |= (1 << c->speed);
+	if (c->speed == _speed) {
+		_timing.readSample = c->readSample;
+		_timing.readRecovery = c->readRecovery;
+	}
+	return true;
+}
+#endif
+
+//
+// Public primitives: they all go through the backend
+//
+uint8_t OWcomponent::reset(void)
+{
+	uint8_t r;
+
+	if (_pullup)
+		pullup_wait();
+	STAT_TIME_BEGIN();
+
+	r = bus_reset();
+	STAT_TIME_END();
+	_epoch++;
+	STAT_INC(resets);
+	if (!r)
+		STAT_INC(noPresence);
+	return r;
+}
+
+void OWcomponent::write_bit(uint8_t v)
+{
+	if (_pullup)
+		pullup_wait();
+	STAT_TIME_BEGIN();
+
+	bus_write_bit(v);
+	STAT_TIME_END();
+}
+
+uint8_t OWcomponent::read_bit(void)
+{
+	uint8_t r;
+
+	if (_pullup)
+		pullup_wait();
+	STAT_TIME_BEGIN();
+
+	r = bus_read_bit();
+	STAT_TIME_END();
+	return r;
+}
+
+void OWcomponent::write(uint8_t v, uint8_t power /* = 0 */)
+{
+	if (_pullup)
+		pullup_wait();
+	STAT_TIME_BEGIN();
+
+	bus_write(v, power);
+	STAT_TIME_END();
+	STAT_INC(bytesWritten);
+}
+
+uint8_t OWcomponent::read(void)
+{
+	uint8_t r;
+
+	if (_pullup)
+		pullup_wait();
+	STAT_TIME_BEGIN();
+
+	r = bus_read();
+	STAT_TIME_END();
+	STAT_INC(bytesRead);
+	return r;
+}
+
+void OWcomponent::depower(void)
+{
+	STAT_TIME_BEGIN();
+
+	// an explicit depower ends the strong pullup window too
+	_pullup = false;
+	bus_depower();
+	STAT_TIME_END();
+}
+
+//
+// Strong pullup scheduling: the line stays powered until the window
+// is over, all the traffic waits for it
+//
+void OWcomponent::strong_pullup(uint16_t ms)
+{
+	_pullupStart = millis();
+	_pullupMs = ms;
+	_pullup = true;
+}
+
+bool OWcomponent::pullup_active(void)
+{
+	// millis() may tick right after the start: one more tick ensures the full window
+	if (_pullup && millis() - _pullupStart > _pullupMs)
+		depower();
+	return _pullup;
+}
+
+void OWcomponent::pullup_wait(void)
+{
+	while (pullup_active())
+		;
+}
+
+void OWcomponent::getStats(OWstats *s)
+{
+#if ONEWIRE_STATS
+	memcpy(s, &_stats, sizeof(OWstats));
+#else
+	memset(s, 0, sizeof(OWstats));
+#endif
+}
+
+void OWcomponent::clearStats(void)
+{
+#if ONEWIRE_STATS
+	memset(&_stats, 0, sizeof(OWstats));
+	_selectMicros = 0;
+#endif
+}
+
+//
+// Run a whole transaction: reset, ROM command, command and data bytes,
+// then read the answer checking its CRC on the fly
+//
+uint16_t OWcomponent::execute(const OWtransaction *t, uint8_t *rom, uint8_t *buf, uint8_t flags)
+{
+	uint8_t i, n, v;
+	uint16_t crc = 0;
+
+	flags |= t->flags;
+	// a check compiled out must not let the bytes through unchecked
+#if !ONEWIRE_CRC
+	if (flags & (OW_TXN_CRC8 | OW_TXN_CRC16))
+		return setError(ERROR_NOT_SUPPORTED);
+#elif !ONEWIRE_CRC16
+	if (flags & OW_TXN_CRC16)
+		return setError(ERROR_NOT_SUPPORTED);
+#endif
+#if ONEWIRE_STATS
+	unsigned long t0 = micros();
+#endif
+
+	if ((flags & OW_TXN_RESET) && !reset()) {
+#if ONEWIRE_STATS
+		_selectMicros = micros() - t0;
+#endif
+		return setError(ERROR_NO_PRESENCE);
+	}
+
+	if (flags & OW_TXN_MATCH)
+		address(rom);
+	else if (flags & OW_TXN_SKIP)
+		skip();
+#if ONEWIRE_STATS
+	_selectMicros = micros() - t0;
+#endif
+
+	n = t->cmdLen + t->writeLen;
+	for (i = 0; i < n; i++) {
+		v = (i < t->cmdLen) ? t->cmd[i] : buf[i - t->cmdLen];
+		// the pullup only makes sense after the last byte
+		write(v, (flags & OW_TXN_PULLUP) && i == n - 1);
+#if ONEWIRE_CRC && ONEWIRE_CRC16
+		if (flags & OW_TXN_CRC16)
+			crc = crc16_update(crc, v);
+#endif
+	}
+
+	if (!t->readLen)
+		return ERROR_NONE;
+
+#if ONEWIRE_CRC
+	if (flags & OW_TXN_CRC8) {
+		if (!read_bytes_crc8(buf, t->readLen))
+			return getError();
+		return ERROR_NONE;
+	}
+#if ONEWIRE_CRC16
+	if (flags & OW_TXN_CRC16) {
+		if (!read_bytes_crc16(buf, t->readLen, crc))
+			return getError();
+		return ERROR_NONE;
+	}
+#endif
+#endif
+	read_bytes(buf, t->readLen);
+	return ERROR_NONE;
+}
+
+uint16_t OWcomponent::execute_P(const OWtransaction *t, uint8_t *rom, uint8_t *buf, uint8_t flags)
+{
+	OWtransaction tmp;
+
+	memcpy_P(&tmp, t, sizeof(OWtransaction));
+	return execute(&tmp, rom, buf, flags);
 }
 
 #if ONEWIRE_SEARCH
@@ -307,6 +838,8 @@ void OWcomponent::reset_search()
   LastDiscrepancy = 0;
   LastDeviceFlag = FALSE;
   LastFamilyDiscrepancy = 0;
+  Counting = FALSE;
+  DevicesFound = 0;
   for(int i = 7; ; i--)
     {
     ROM_NO[i] = 0;
@@ -334,7 +867,7 @@ bool OWcomponent::search(uint8_t *newAddr, uint8_t cmd)
 {
    uint8_t id_bit_number;
    uint8_t last_zero, rom_byte_number, search_result;
-   uint8_t id_bit, cmp_id_bit;
+   uint8_t id_bit, cmp_id_bit, triplet;
 
    unsigned char rom_byte_mask, search_direction;
 
@@ -345,6 +878,13 @@ bool OWcomponent::search(uint8_t *newAddr, uint8_t cmd)
    rom_byte_mask = 1;
    search_result = 0;
 
+   // a generic search started from scratch enumerates the whole bus,
+   // so count the devices found along the way
+   if (!LastDiscrepancy && !LastDeviceFlag) {
+      Counting = (cmd == CMD_GENERIC_SEARCH);
+      DevicesFound = 0;
+   }
+
    // if the last call was not the last one
    if (!LastDeviceFlag)
    {
@@ -359,33 +899,34 @@ bool OWcomponent::search(uint8_t *newAddr, uint8_t cmd)
       }
 
       // issue the search command
-      write(cmd);
+      search_command(cmd);
 
       // loop to do the search
       do
       {
-         // read a bit and its complement
-         id_bit = read_bit();
-         cmp_id_bit = read_bit();
+         // direction to take in case of a discrepancy:
+         // if this discrepancy if before the Last Discrepancy
+         // on a previous next then pick the same as last time
+         if (id_bit_number < LastDiscrepancy)
+            search_direction = ((ROM_NO[rom_byte_number] & rom_byte_mask) > 0);
+         else
+            // if equal to last pick 1, if not then pick 0
+            search_direction = (id_bit_number == LastDiscrepancy);
+
+         // read a bit and its complement, then write the direction
+         triplet = OWcomponent::triplet(search_direction);
+         id_bit = triplet & 0x01;
+         cmp_id_bit = (triplet >> 1) & 0x01;
 
          // check for no devices on 1-wire
          if ((id_bit == 1) && (cmp_id_bit == 1))
             break;
          else
          {
-            // all devices coupled have 0 or 1
-            if (id_bit != cmp_id_bit)
-               search_direction = id_bit;  // bit write value for search
-            else
+            // direction actually taken
+            search_direction = (triplet >> 2) & 0x01;
+            if (id_bit == cmp_id_bit)
             {
-               // if this discrepancy if before the Last Discrepancy
-               // on a previous next then pick the same as last time
-               if (id_bit_number < LastDiscrepancy)
-                  search_direction = ((ROM_NO[rom_byte_number] & rom_byte_mask) > 0);
-               else
-                  // if equal to last pick 1, if not then pick 0
-                  search_direction = (id_bit_number == LastDiscrepancy);
-
                // if 0 was picked then record its position in LastZero
                if (search_direction == 0)
                {
@@ -404,9 +945,6 @@ bool OWcomponent::search(uint8_t *newAddr, uint8_t cmd)
             else
               ROM_NO[rom_byte_number] &= ~rom_byte_mask;
 
-            // serial number search direction write bit
-            write_bit(search_direction);
-
             // increment the byte counter id_bit_number
             // and shift the mask rom_byte_mask
             id_bit_number++;
@@ -422,6 +960,10 @@ bool OWcomponent::search(uint8_t *newAddr, uint8_t cmd)
       }
       while(rom_byte_number < 8);  // loop until through all ROM bytes 0-7
 
+      // devices answered, then stopped in the middle of the ROM
+      if (id_bit_number > 1 && id_bit_number < 65)
+         STAT_INC(searchRestarts);
+
       // if the search was successful then
       if (!(id_bit_number < 65))
       {
@@ -433,6 +975,10 @@ bool OWcomponent::search(uint8_t *newAddr, uint8_t cmd)
             LastDeviceFlag = TRUE;
 
          search_result = TRUE;
+
+         // the device found is now the target of a RESUME command
+         for (int i = 0; i < 8; i++) _lastRom[i] = ROM_NO[i];
+         _resumeValid = supportsResume(ROM_NO[0]);
       }
    }
 
@@ -443,11 +989,136 @@ bool OWcomponent::search(uint8_t *newAddr, uint8_t cmd)
       LastDeviceFlag = FALSE;
       LastFamilyDiscrepancy = 0;
       search_result = FALSE;
+      Counting = FALSE;
+   }
+   else if (Counting) {
+      DevicesFound++;
+      if (LastDeviceFlag) {
+         _devCount = DevicesFound;
+         Counting = FALSE;
+      }
    }
    for (int i = 0; i < 8; i++) newAddr[i] = ROM_NO[i];
    return search_result;
   }
 
+void OWcomponent::search_command(uint8_t cmd)
+{
+   write(cmd);
+   _resumeValid = false;  // any ROM command but RESUME clears the RESUME flag of the devices
+}
+
+uint8_t OWcomponent::triplet(uint8_t direction)
+{
+   uint8_t r;
+
+   if (_pullup)
+      pullup_wait();
+   STAT_TIME_BEGIN();
+
+   r = bus_triplet(direction);
+   STAT_TIME_END();
+   return r;
+}
+
+//
+// Setup the search to find the device type 'family' on the next call
+// to search() if it is present. Taken from Maxim Application Note 187.
+//
+void OWcomponent::target_search(uint8_t family)
+{
+   // set the search state to find SearchFamily type devices
+   ROM_NO[0] = family;
+   for (uint8_t i = 1; i < 8; i++)
+      ROM_NO[i] = 0;
+   LastDiscrepancy = 64;
+   LastFamilyDiscrepancy = 0;
+   LastDeviceFlag = FALSE;
+   Counting = FALSE;
+}
+
+//
+// Setup the search to skip the current device type on the next call
+// to search().
+//
+void OWcomponent::skip_family(void)
+{
+   // set the Last discrepancy to last family discrepancy
+   LastDiscrepancy = LastFamilyDiscrepancy;
+   LastFamilyDiscrepancy = 0;
+
+   // check for end of list
+   if (LastDiscrepancy == 0)
+      LastDeviceFlag = TRUE;
+   Counting = FALSE;
+}
+
+bool OWcomponent::search_family(uint8_t *newAddr, uint8_t family, uint8_t cmd)
+{
+   // a fresh search state means that we start a new enumeration
+   if (!LastDiscrepancy && !LastDeviceFlag)
+      target_search(family);
+
+   if (search(newAddr, cmd) && newAddr[0] == family)
+      return TRUE;
+
+   // either no more devices or we went past the family
+   reset_search();
+   return FALSE;
+}
+
+//
+// Verify that the device with the given ROM number is present on the
+// bus. The search state is restored afterwards.
+//
+bool OWcomponent::verify(uint8_t rom[8])
+{
+   uint8_t rom_backup[8];
+   uint8_t ld_backup, lfd_backup, ldf_backup, counting_backup;
+   uint8_t found[8];
+   bool result = FALSE;
+   uint8_t i;
+
+   // keep a backup copy of the current state
+   for (i = 0; i < 8; i++)
+      rom_backup[i] = ROM_NO[i];
+   ld_backup = LastDiscrepancy;
+   ldf_backup = LastDeviceFlag;
+   lfd_backup = LastFamilyDiscrepancy;
+   counting_backup = Counting;
+
+   // set search to find the same device
+   for (i = 0; i < 8; i++)
+      ROM_NO[i] = rom[i];
+   LastDiscrepancy = 64;
+   LastDeviceFlag = FALSE;
+   Counting = FALSE;
+
+   if (search(found, CMD_GENERIC_SEARCH))
+   {
+      // check if same device found
+      result = TRUE;
+      for (i = 0; i < 8; i++)
+      {
+         if (rom[i] != found[i])
+         {
+            result = FALSE;
+            break;
+         }
+      }
+   }
+
+   // restore the search state
+   for (i = 0; i < 8; i++)
+      ROM_NO[i] = rom_backup[i];
+   LastDiscrepancy = ld_backup;
+   LastDeviceFlag = ldf_backup;
+   LastFamilyDiscrepancy = lfd_backup;
+   Counting = counting_backup;
+
+   return result;
+}
+
 #endif
 
 #if ONEWIRE_CRC
@@ -455,95 +1126,118 @@ bool OWcomponent::search(uint8_t *newAddr, uint8_t cmd)
 // "Understanding and Using Cyclic Redundancy Checks with Maxim iButton Products"
 //
 
-#if ONEWIRE_CRC8_TABLE
-// This table comes from Dallas sample code where it is freely reusable,
-// though Copyright (C) 2000 Dallas Semiconductor Corporation
-static const uint8_t PROGMEM dscrc_table[] = {
-      0, 94,188,226, 97, 63,221,131,194,156,126, 32,163,253, 31, 65,
-    157,195, 33,127,252,162, 64, 30, 95,  1,227,189, 62, 96,130,220,
-     35,125,159,193, 66, 28,254,160,225,191, 93,  3,128,222, 60, 98,
-    190,224,  2, 92,223,129, 99, 61,124, 34,192,158, 29, 67,161,255,
-     70, 24,250,164, 39,121,155,197,132,218, 56,102,229,187, 89,  7,
-    219,133,103, 57,186,228,  6, 88, 25, 71,165,251,120, 38,196,154,
-    101, 59,217,135,  4, 90,184,230,167,249, 27, 69,198,152,122, 36,
-    248,166, 68, 26,153,199, 37,123, 58,100,134,216, 91,  5,231,185,
-    140,210, 48,110,237,179, 81, 15, 78, 16,242,172, 47,113,147,205,
-     17, 79,173,243,112, 46,204,146,211,141,111, 49,178,236, 14, 80,
-    175,241, 19, 77,206,144,114, 44,109, 51,209,143, 12, 82,176,238,
-     50,108,142,208, 83, 13,239,177,240,174, 76, 18,145,207, 45,115,
-    202,148,118, 40,171,245, 23, 73,  8, 86,180,234,105, 55,213,139,
-     87,  9,235,181, 54,104,138,212,149,203, 41,119,244,170, 72, 22,
-    233,183, 85, 11,136,214, 52,106, 43,117,151,201, 74, 20,246,168,
-    116, 42,200,150, 21, 75,169,247,182,232, 10, 84,215,137,107, 53};
-
 //
 // Compute a Dallas Semiconductor 8 bit CRC. These show up in the ROM
-// and the registers.  (note: this might better be done without to
-// table, it would probably be smaller and certainly fast enough
-// compared to all those delayMicrosecond() calls.  But I got
-// confused, so I use this table from the examples.)
+// and the registers. The kernel is chosen by ONEWIRE_CRC8_KERNEL.
 //
 uint8_t OWcomponent::crc8( uint8_t *addr, uint8_t len)
 {
 	uint8_t crc = 0;
 
-	while (len--) {
-		crc = pgm_read_byte(dscrc_table + (crc ^ *addr++));
-	}
+	while (len--)
+		crc = crc8_update(crc, *addr++);
 	return crc;
 }
+
+uint8_t OWcomponent::crc8_update(uint8_t crc, uint8_t data)
+{
+#if ONEWIRE_CRC8_KERNEL == OW_CRC_KERNEL_TABLE
+	return OWcrc::crc8_table(crc, data);
+#elif ONEWIRE_CRC8_KERNEL == OW_CRC_KERNEL_NIBBLE
+	return OWcrc::crc8_nibble(crc, data);
 #else
+	return OWcrc::crc8_bitwise(crc, data);
+#endif
+}
+
 //
-// Compute a Dallas Semiconductor 8 bit CRC directly.
-// this is much slower, but much smaller, than the lookup table.
+// Read bytes and compute their CRC on the fly. A correct block
+// (data followed by its CRC) has a null CRC.
 //
-uint8_t OWcomponent::crc8( uint8_t *addr, uint8_t len)
+bool OWcomponent::read_bytes_crc8(uint8_t *buf, uint16_t count, const uint8_t *expect, const uint8_t *mask)
 {
 	uint8_t crc = 0;
-	
-	while (len--) {
-		uint8_t inbyte = *addr++;
-		for (uint8_t i = 8; i; i--) {
-			uint8_t mix = (crc ^ inbyte) & 0x01;
-			crc >>= 1;
-			if (mix) crc ^= 0x8C;
-			inbyte >>= 1;
+
+	for (uint16_t i = 0 ; i < count ; i++) {
+		buf[i] = read();
+		if (expect && mask && ((buf[i] ^ expect[i]) & mask[i])) {
+			// no chance for this block to be good: stop the transfer
+			reset();
+			setError(ERROR_READ_FAILURE);
+			return false;
 		}
+		crc = crc8_update(crc, buf[i]);
 	}
-	return crc;
+	if (crc) {
+		STAT_INC(crc8Errors);
+		setError(ERROR_INVALID_CRC);
+		return false;
+	}
+	return true;
 }
-#endif
 
 #if ONEWIRE_CRC16
-bool OWcomponent::check_crc16(uint8_t* input, uint16_t len, uint8_t* inverted_crc)
+bool OWcomponent::check_crc16(uint8_t* input, uint16_t len, uint8_t* inverted_crc, uint16_t crc)
 {
-    uint16_t crc = ~crc16(input, len);
+    crc = ~crc16(input, len, crc);
     return (crc & 0xFF) == inverted_crc[0] && (crc >> 8) == inverted_crc[1];
 }
 
-uint16_t OWcomponent::crc16(uint8_t* input, uint16_t len)
+uint16_t OWcomponent::crc16(uint8_t* input, uint16_t len, uint16_t crc)
 {
-    static const uint8_t oddparity[16] =
-        { 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0 };
-    uint16_t crc = 0;    // Starting seed is zero.
-
-    for (uint16_t i = 0 ; i < len ; i++) {
-      // Even though we're just copying a byte from the input,
-      // we'll be doing 16-bit computation with it.
-      uint16_t cdata = input[i];
-      cdata = (cdata ^ (crc & 0xff)) & 0xff;
-      crc >>= 8;
+    for (uint16_t i = 0 ; i < len ; i++)
+      crc = crc16_update(crc, input[i]);
+    return crc;
+}
 
-      if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
-          crc ^= 0xC001;
+uint16_t OWcomponent::crc16_update(uint16_t crc, uint8_t data)
+{
+#if ONEWIRE_CRC16_KERNEL == OW_CRC_KERNEL_TABLE
+    return OWcrc::crc16_table(crc, data);
+#elif ONEWIRE_CRC16_KERNEL == OW_CRC_KERNEL_NIBBLE
+    return OWcrc::crc16_nibble(crc, data);
+#elif ONEWIRE_CRC16_KERNEL == OW_CRC_KERNEL_BITWISE
+    return OWcrc::crc16_bitwise(crc, data);
+#else
+    return OWcrc::crc16_parity(crc, data);
+#endif
+}
 
-      cdata <<= 6;
-      crc ^= cdata;
-      cdata <<= 1;
-      crc ^= cdata;
+uint16_t OWcomponent::write_bytes_crc16(const uint8_t *buf, uint16_t count, uint16_t crc, bool power)
+{
+    for (uint16_t i = 0 ; i < count ; i++) {
+      write(buf[i], power);
+      crc = crc16_update(crc, buf[i]);
     }
+    if (!power)
+      depower();
     return crc;
 }
+
+//
+// Read bytes and compute their CRC16 on the fly. Since the CRC is sent
+// inverted, a correct block (data followed by its inverted CRC) leaves
+// the constant residue 0xB001.
+//
+bool OWcomponent::read_bytes_crc16(uint8_t *buf, uint16_t count, uint16_t crc, const uint8_t *expect, const uint8_t *mask)
+{
+    for (uint16_t i = 0 ; i < count ; i++) {
+      buf[i] = read();
+      if (expect && mask && ((buf[i] ^ expect[i]) & mask[i])) {
+        // no chance for this block to be good: stop the transfer
+        reset();
+        setError(ERROR_READ_FAILURE);
+        return false;
+      }
+      crc = crc16_update(crc, buf[i]);
+    }
+    if (crc != 0xB001) {
+      STAT_INC(crc16Errors);
+      setError(ERROR_INVALID_CRC);
+      return false;
+    }
+    return true;
+}
 #endif
 
 #endif
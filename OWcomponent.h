@@ -35,6 +35,7 @@
 #endif
 
 #include "Error.h"
+#include "OWcrc.h"
 
 #define FAM_CODE_DB18S20 0x10
 #define FAM_CODE_DB18B20 0x28
@@ -44,6 +45,44 @@
 #define CMD_READ_ROM 0x33
 #define CMD_MATCH_ROM 0x55
 #define CMD_SKIP_ROM 0xCC
+#define CMD_RESUME 0xA5
+#define CMD_OVERDRIVE_SKIP 0x3C
+#define CMD_OVERDRIVE_MATCH 0x69
+
+/**
+ \name Bus speeds
+ \brief Macro definitions for the speeds of the 1-Wire bus.
+ */
+//@{
+/**
+ \def OW_SPEED_STANDARD 0
+ \brief Standard speed (about 15 kbps).
+ */
+#define OW_SPEED_STANDARD 0
+/**
+ \def OW_SPEED_OVERDRIVE 1
+ \brief Overdrive speed (about 110 kbps). Only some devices support it.
+ */
+#define OW_SPEED_OVERDRIVE 1
+//@}
+
+/**
+ \name Addressing policies
+ \brief Macro definitions for the policies used by \c OWcomponent::address() to address a device.
+ */
+//@{
+/**
+ \def OW_ADDRESSING_MATCH 0
+ \brief Always address devices with MATCH ROM.
+ */
+#define OW_ADDRESSING_MATCH 0
+/**
+ \def OW_ADDRESSING_AUTO 1
+ \brief Use SKIP ROM when the bus holds exactly one device, RESUME when the same device is addressed
+ again and it supports it, MATCH ROM otherwise.
+ */
+#define OW_ADDRESSING_AUTO 1
+//@}
 
 // You can exclude certain features from OneWire.  In theory, this
 // might save some space.  In practice, the compiler automatically
@@ -74,27 +113,210 @@
 #define ONEWIRE_CRC8_TABLE 1
 #endif
 
+// For finer control, select the kernel used for the 8-bit CRC
+// (OW_CRC_KERNEL_BITWISE, OW_CRC_KERNEL_NIBBLE or OW_CRC_KERNEL_TABLE)
+// and for the 16-bit CRC (same choices, plus OW_CRC_KERNEL_PARITY).
+// See OWcrc.h for their sizes, and extras/crcbench for their speeds.
+#ifndef ONEWIRE_CRC8_KERNEL
+#if ONEWIRE_CRC8_TABLE
+#define ONEWIRE_CRC8_KERNEL OW_CRC_KERNEL_TABLE
+#else
+#define ONEWIRE_CRC8_KERNEL OW_CRC_KERNEL_BITWISE
+#endif
+#endif
+
+#ifndef ONEWIRE_CRC16_KERNEL
+#define ONEWIRE_CRC16_KERNEL OW_CRC_KERNEL_PARITY
+#endif
+
 // You can allow 16-bit CRC checks by defining this to 1
 // (Note that ONEWIRE_CRC must also be 1.)
 #ifndef ONEWIRE_CRC16
 #define ONEWIRE_CRC16 1
 #endif
 
+// Bus health counters are kept unless this is defined to 0
+#ifndef ONEWIRE_STATS
+#define ONEWIRE_STATS 1
+#endif
+
+// Define this to 1 to also measure the time spent in the bus primitives
+// and the longest window with interrupts disabled. This adds a call to
+// micros() around each primitive and each slot.
+#ifndef ONEWIRE_STATS_TIMING
+#define ONEWIRE_STATS_TIMING 0
+#endif
+
 #define FALSE 0
 #define TRUE  1
 
+/**
+ \struct OWtiming
+ \brief Timings (in microseconds) of the reset, write and read slots.
+ \details Letters refer to the timings of Maxim Application Note 126.
+ */
+typedef struct {
+	uint16_t resetLow;       // H: reset pulse
+	uint8_t presenceSample;  // I: release to presence sample
+	uint16_t resetRecovery;  // J: end of the presence detect window
+	uint8_t write1Low;       // A: low time of a write 1 slot
+	uint8_t write1Recovery;  // B: rest of the write 1 slot
+	uint8_t write0Low;       // C: low time of a write 0 slot
+	uint8_t write0Recovery;  // D: recovery after a write 0 slot
+	uint8_t readLow;         // A: low time of a read slot
+	uint8_t readSample;      // E: release to sample
+	uint8_t readRecovery;    // F: rest of the read slot
+} OWtiming;
+
+/**
+ \struct OWcalibration
+ \brief Read slot timings found by \c OWcomponent::calibrate(), in a form suitable for storing in EEPROM.
+ \details The last byte is the inverted 8 bit CRC of the other ones, so that a blank (all 0s or all 1s) or
+ corrupted copy is rejected by \c OWcomponent::setCalibration().
+ */
+typedef struct {
+	uint8_t speed;         // OW_SPEED_XXX the timings apply to
+	uint8_t readSample;    // E: release to sample
+	uint8_t readRecovery;  // F: rest of the read slot
+	uint8_t crc;           // inverted CRC8 of the bytes above
+} OWcalibration;
+
+/**
+ \name Calibration parameters
+ \brief Macro definitions for the ranges swept by \c OWcomponent::calibrate().
+ */
+//@{
+/**
+ \def OW_CAL_TRIES 8
+ \brief Number of consecutive good reads required to accept a setting.
+ */
+#define OW_CAL_TRIES 8
+/**
+ \def OW_CAL_SAMPLE_MAX 40
+ \brief Largest sample delay (in microseconds) tried at standard speed.
+ */
+#define OW_CAL_SAMPLE_MAX 40
+/**
+ \def OW_CAL_SAMPLE_MAX_OD 6
+ \brief Largest sample delay (in microseconds) tried at overdrive speed.
+ */
+#define OW_CAL_SAMPLE_MAX_OD 6
+/**
+ \def OW_SLOT_MIN 61
+ \brief Shortest time slot (in microseconds) at standard speed, recovery included (tSLOT + tREC).
+ */
+#define OW_SLOT_MIN 61
+/**
+ \def OW_SLOT_MIN_OD 7
+ \brief Shortest time slot (in microseconds) at overdrive speed, recovery included (tSLOT + tREC).
+ */
+#define OW_SLOT_MIN_OD 7
+//@}
+
+/**
+ \struct OWstats
+ \brief Health counters of a 1-Wire bus, see \c OWcomponent::getStats().
+ \details The timing fields stay at 0 unless \c ONEWIRE_STATS_TIMING is defined to 1.
+ */
+typedef struct {
+	uint32_t resets;          // reset pulses sent
+	uint16_t noPresence;      // resets without presence pulse
+	uint16_t shorts;          // resets finding the bus held low
+	uint16_t crc8Errors;      // CRC8 mismatches in read_bytes_crc8()
+	uint16_t crc16Errors;     // CRC16 mismatches in read_bytes_crc16()
+	uint16_t searchRestarts;  // search passes aborted in the middle of a ROM
+	uint32_t bytesWritten;    // bytes written by write()
+	uint32_t bytesRead;       // bytes read by read()
+	uint32_t busMicros;       // time spent in the bus primitives
+	uint16_t maxIrqOff;       // longest window with interrupts disabled (bit-banging only)
+} OWstats;
+
+/**
+ \name Transaction flags
+ \brief Macro definitions for the steps of an \c OWtransaction.
+ */
+//@{
+/**
+ \def OW_TXN_RESET 0x01
+ \brief Starts with a reset. The transaction fails with \c ERROR_NO_PRESENCE if no device answers.
+ */
+#define OW_TXN_RESET 0x01
+/**
+ \def OW_TXN_SKIP 0x02
+ \brief Addresses all the devices with SKIP ROM.
+ */
+#define OW_TXN_SKIP 0x02
+/**
+ \def OW_TXN_MATCH 0x04
+ \brief Addresses one device through \c address(), ie according to the addressing policy.
+ */
+#define OW_TXN_MATCH 0x04
+/**
+ \def OW_TXN_CRC8 0x08
+ \brief The bytes read end with an 8 bit CRC, which is checked.
+ */
+#define OW_TXN_CRC8 0x08
+/**
+ \def OW_TXN_CRC16 0x10
+ \brief The bytes read end with an inverted CRC16 covering the bytes written too, which is checked.
+ */
+#define OW_TXN_CRC16 0x10
+/**
+ \def OW_TXN_PULLUP 0x20
+ \brief The strong pullup is left on after the last byte written. Call \c depower() when done.
+ */
+#define OW_TXN_PULLUP 0x20
+//@}
+
+/**
+ \def OW_TXN_MAX_CMD 4
+ \brief Maximal number of command bytes stored in an \c OWtransaction.
+ */
+#define OW_TXN_MAX_CMD 4
+
+/**
+ \struct OWtransaction
+ \brief Description of a complete 1-Wire transaction: reset, ROM command, command bytes, data bytes written
+ and bytes read.
+ \details Transactions are executed by \c OWcomponent::execute() in a single call. They only hold constant data
+ and can be stored in flash, see \c OWcomponent::execute_P().
+ */
+typedef struct {
+	uint8_t flags;                // OW_TXN_XXX flags
+	uint8_t cmdLen;               // number of command bytes
+	uint8_t cmd[OW_TXN_MAX_CMD];  // command bytes
+	uint8_t writeLen;             // number of bytes written from the caller buffer after the command
+	uint8_t readLen;              // number of bytes read into the caller buffer (CRC included)
+} OWtransaction;
+
 // Platform specific I/O definitions
 
+#if defined(ONEWIRE_SIM)
+// Host simulator, see extras/host/OWsim.h
+#include "OWsim.h"
+#define PIN_TO_BASEREG(pin)             (portInputRegister(digitalPinToPort(pin)))
+#define PIN_TO_BITMASK(pin)             (digitalPinToBitMask(pin))
+#define IO_REG_TYPE uint8_t
+#define IO_REG_ASM
+#define DIRECT_READ(base, mask)         (owsim_read((base), (mask)) ? 1 : 0)
+#define DIRECT_READ_MASK(base, mask)    owsim_read((base), (mask))
+#define DIRECT_MODE_INPUT(base, mask)   owsim_write((base), 1, (mask), 0)
+#define DIRECT_MODE_OUTPUT(base, mask)  owsim_write((base), 1, (mask), 1)
+#define DIRECT_WRITE_LOW(base, mask)    owsim_write((base), 2, (mask), 0)
+#define DIRECT_WRITE_HIGH(base, mask)   owsim_write((base), 2, (mask), 1)
+#else
 /* #if defined(__AVR__) */
 #define PIN_TO_BASEREG(pin)             (portInputRegister(digitalPinToPort(pin)))
 #define PIN_TO_BITMASK(pin)             (digitalPinToBitMask(pin))
 #define IO_REG_TYPE uint8_t
 #define IO_REG_ASM asm("r30")
 #define DIRECT_READ(base, mask)         (((*(base)) & (mask)) ? 1 : 0)
+#define DIRECT_READ_MASK(base, mask)    ((*(base)) & (mask))
 #define DIRECT_MODE_INPUT(base, mask)   ((*(base+1)) &= ~(mask))
 #define DIRECT_MODE_OUTPUT(base, mask)  ((*(base+1)) |= (mask))
 #define DIRECT_WRITE_LOW(base, mask)    ((*(base+2)) &= ~(mask))
 #define DIRECT_WRITE_HIGH(base, mask)   ((*(base+2)) |= (mask))
+#endif
 /*
 #elif defined(__PIC32MX__)
 #include <plib.h>  // is this necessary?
@@ -125,16 +347,111 @@ private:
     uint8_t LastDiscrepancy;
     uint8_t LastFamilyDiscrepancy;
     uint8_t LastDeviceFlag;
+    // device counting during a full enumeration
+    uint8_t Counting;
+    uint8_t DevicesFound;
+#endif
+
+    // addressing state
+    uint8_t _addressing;
+    uint8_t _devCount;
+    uint8_t _lastRom[8];
+    bool _resumeValid;
+
+    // speed state
+    uint8_t _speed;
+    bool _overdrive;
+    bool _odAll;
+    OWtiming _timing;
+    // calibrated read slot timings, per speed
+    uint8_t _calibrated;
+    uint8_t _calSample[2];
+    uint8_t _calRecovery[2];
+
+    // number of resets so far, to detect traffic between two calls
+    uint8_t _epoch;
+
+    // strong pullup window
+    bool _pullup;
+    unsigned long _pullupStart;
+    uint16_t _pullupMs;
+
+#if ONEWIRE_STATS
+    // health counters
+    OWstats _stats;
+    // reset and ROM command of the last transaction, in microseconds
+    uint16_t _selectMicros;
+#if ONEWIRE_STATS_TIMING
+    unsigned long _irqStart;
+#endif
+#endif
+
+    void init(void);
+#if ONEWIRE_CRC
+    bool calibration_test(uint8_t *rom, uint8_t tries);
 #endif
   
 protected:
 
 	/**
-	 \var uint8_t *_adr
+	 \var uint8_t _adr[8]
 	 \brief Address of this component on the 1-Wire bus. Remark that this address is obtained from the \c search() operation
 	 in the constructor. I'm not sure that this operation is thread safe.
 	 */
-	uint8_t *_adr; // address of this component on the bus
+	uint8_t _adr[8]; // address of this component on the bus
+
+	/**
+	 \fn OWcomponent(void)
+	 \brief Constructor for backends which do not drive a pin directly (bridges, UARTs, etc.).
+	 \details Backends override the \c bus_XXX functions below. All the other functions (\c select(), \c search(),
+	 etc.) are built on top of them.
+	 */
+    OWcomponent(void);
+
+	/**
+	 \fn void reset_bus_state(void)
+	 \brief Forgets everything known about the devices on the bus (search state, device count, RESUME target).
+	 \details Backends call this when they switch to another physical bus.
+	 */
+    void reset_bus_state(void);
+
+	/**
+	 \fn void count_short(void)
+	 \brief Backends call this when a reset finds the bus shorted (held low).
+	 */
+    inline void count_short(void) {
+#if ONEWIRE_STATS
+        _stats.shorts++;
+#endif
+    }
+
+	/**
+	 \name Backend primitives
+	 \brief Primitives actually driving the bus. The default implementation bit-bangs the pin passed to the
+	 constructor. See the public functions having the same name (without \c bus_) for their semantics.
+	 */
+	//@{
+    virtual uint8_t bus_reset(void);
+    virtual void bus_write_bit(uint8_t v);
+    virtual uint8_t bus_read_bit(void);
+    virtual void bus_write(uint8_t v, uint8_t power);
+    virtual uint8_t bus_read(void);
+    virtual void bus_depower(void);
+	/**
+	 \fn virtual uint8_t bus_triplet(uint8_t direction)
+	 \brief Performs one step of the search algorithm: reads a bit and its complement, then writes the search
+	 direction.
+	 @param direction Direction to take if the bit and its complement are both 0 (a discrepancy).
+	 \return Bit 0 is the bit read, bit 1 its complement and bit 2 the direction taken. If both bits read are 1
+	 (no device) nothing is written.
+	 */
+    virtual uint8_t bus_triplet(uint8_t direction);
+	/**
+	 \fn virtual void bus_speed(uint8_t speed)
+	 \brief Called by \c setSpeed() once the new slot timings are in place.
+	 */
+    virtual void bus_speed(uint8_t speed);
+	//@}
 	
 public:
 	/**
@@ -164,6 +481,136 @@ public:
 	 \brief Issues a 1-Wire rom skip command, to address all slaves on the bus.
 	 */
     void skip(void);
+
+	/**
+	 \fn void address(uint8_t rom[8])
+	 \brief Address the device \c rom according to the current addressing policy, you do the reset first.
+	 \details With \c OW_ADDRESSING_AUTO, SKIP ROM is used when the last full enumeration found exactly one
+	 device on the bus (or when \c setDeviceCount(1) has been called), RESUME is used when \c rom was the
+	 last device addressed and it supports this command. MATCH ROM is used in all the other cases.
+	 @param rom Address of the device to address.
+	 @see setAddressing, setDeviceCount
+	 */
+    void address(uint8_t rom[8]);
+
+	/**
+	 \fn void setAddressing(uint8_t policy)
+	 \brief Sets the policy used by \c address().
+	 @param policy Either \c OW_ADDRESSING_MATCH or \c OW_ADDRESSING_AUTO (the default).
+	 */
+    inline void setAddressing(uint8_t policy) { _addressing = policy; }
+	/**
+	 \fn uint8_t getAddressing(void)
+	 \brief Returns the policy used by \c address().
+	 */
+    inline uint8_t getAddressing(void) { return _addressing; }
+	/**
+	 \fn const uint8_t *getAddress(void)
+	 \brief Returns the address of this component on the bus (all zeros until a derived class obtains it).
+	 */
+    inline const uint8_t *getAddress(void) { return _adr; }
+
+	/**
+	 \fn uint8_t getDeviceCount(void)
+	 \brief Returns the number of devices found by the last full enumeration, \c 0 if unknown.
+	 */
+    inline uint8_t getDeviceCount(void) { return _devCount; }
+	/**
+	 \fn void setDeviceCount(uint8_t n)
+	 \brief Declares the number of devices on the bus (\c 0 for unknown).
+	 \remark Use this when the wiring is known in advance and no full enumeration is performed. If a device
+	 is added to a bus declared as holding a single device, SKIP ROM will address both of them.
+	 */
+    inline void setDeviceCount(uint8_t n) { _devCount = n; }
+
+	/**
+	 \fn static bool supportsResume(uint8_t family)
+	 \brief Returns \c True if the devices of family \c family implement the RESUME command.
+	 */
+    static bool supportsResume(uint8_t family);
+
+	/**
+	 \fn void overdrive_skip(void)
+	 \brief Issues a 1-Wire overdrive skip command, you do the (standard speed) reset first.
+	 \details All the devices supporting overdrive switch to overdrive speed, and so does the bus. The other
+	 devices wait for the next standard speed reset.
+	 */
+    void overdrive_skip(void);
+
+	/**
+	 \fn void overdrive_select(uint8_t rom[8])
+	 \brief Issues a 1-Wire overdrive match command, you do the (standard speed) reset first.
+	 \details Only the selected device switches to overdrive speed, and so does the bus. The ROM itself is
+	 sent at overdrive speed.
+	 @param rom Address of the rom to select.
+	 */
+    void overdrive_select(uint8_t rom[8]);
+
+	/**
+	 \fn void setSpeed(uint8_t speed)
+	 \brief Sets the speed of the bus.
+	 @param speed Either \c OW_SPEED_STANDARD or \c OW_SPEED_OVERDRIVE.
+	 \remark This only changes the slot timings, it does not send anything on the bus. To bring all the
+	 devices back to standard speed set \c OW_SPEED_STANDARD and then call \c reset().
+	 */
+    void setSpeed(uint8_t speed);
+	/**
+	 \fn uint8_t getSpeed(void)
+	 \brief Returns the current speed of the bus.
+	 */
+    inline uint8_t getSpeed(void) { return _speed; }
+
+	/**
+	 \fn void setOverdrive(bool enable)
+	 \brief Allows \c address() to switch devices supporting it to overdrive speed.
+	 \details When enabled, \c address() uses the overdrive skip/match commands for the devices supporting
+	 overdrive and falls back to a standard speed reset before addressing any other device.
+	 \remark Overdrive slots are only a few microseconds long, use this with fast MCUs (16 MHz or more).
+	 */
+    inline void setOverdrive(bool enable) { _overdrive = enable; }
+
+	/**
+	 \fn static bool supportsOverdrive(uint8_t family)
+	 \brief Returns \c True if the devices of family \c family support overdrive speed.
+	 */
+    static bool supportsOverdrive(uint8_t family);
+
+	/**
+	 \fn static void defaultTiming(uint8_t speed, OWtiming *t)
+	 \brief Copies the default slot timings for speed \c speed into \c t.
+	 @param speed Either \c OW_SPEED_STANDARD or \c OW_SPEED_OVERDRIVE.
+	 @param t Destination of the timings.
+	 */
+    static void defaultTiming(uint8_t speed, OWtiming *t);
+
+#if ONEWIRE_CRC
+	/**
+	 \fn bool calibrate(uint8_t *rom = NULL, uint8_t tries = OW_CAL_TRIES)
+	 \brief Finds the read slot timings giving the widest margin on this bus, at the current speed.
+	 \details The sample delay is swept keeping the slot length, and the middle of the widest range of delays
+	 giving only good reads is kept. The recovery time is never shortened below its default, and the slot is
+	 lengthened if needed to last at least \c OW_SLOT_MIN (\c OW_SLOT_MIN_OD at overdrive speed). A read is good if
+	 the device answers with the right ROM (or a ROM with a valid CRC when \c rom is \c NULL). The settings found
+	 survive speed changes, see \c getCalibration() to store them.
+	 @param rom Address of a device on the bus, or \c NULL if the bus holds a single device (READ ROM is used).
+	 @param tries Number of consecutive good reads required to accept a setting.
+	 \return \c True if working timings have been found, \c False otherwise (\c ERROR_READ_FAILURE is raised and
+	 the timings are left unchanged).
+	 \remark Only the bit-banging backend uses these timings. The health counters are not affected.
+	 */
+    bool calibrate(uint8_t *rom = NULL, uint8_t tries = OW_CAL_TRIES);
+	/**
+	 \fn void getCalibration(OWcalibration *c)
+	 \brief Copies the read slot timings in use at the current speed into \c c, CRC included.
+	 */
+    void getCalibration(OWcalibration *c);
+	/**
+	 \fn bool setCalibration(const OWcalibration *c)
+	 \brief Restores read slot timings saved with \c getCalibration().
+	 \return \c True if they have been applied, \c False if \c c is corrupted (\c ERROR_INVALID_CRC is raised).
+	 */
+    bool setCalibration(const OWcalibration *c);
+#endif
 	
 	/**
 	 \fn void write(uint8_t v, uint8_t power = 0)
@@ -228,6 +675,85 @@ public:
 	 */
     void depower(void);
 
+	/**
+	 \fn uint8_t getEpoch(void)
+	 \brief Returns a counter incremented by each \c reset().
+	 \details Code spreading a sequence of slots over time (an incremental search, for example) compares it with the
+	 value it got after its own reset: if it changed, somebody else used the bus in between and the sequence has
+	 to start over.
+	 */
+    inline uint8_t getEpoch(void) { return _epoch; }
+	/**
+	 \fn uint16_t getSelectTime(void)
+	 \brief Returns the time (in microseconds) taken by the reset and the ROM command of the last transaction run by
+	 \c execute(), that is the cost of addressing a device. When no device answers, the time of the reset alone.
+	 \remark Always 0 if \c ONEWIRE_STATS is defined to 0.
+	 */
+#if ONEWIRE_STATS
+    inline uint16_t getSelectTime(void) { return _selectMicros; }
+#else
+    inline uint16_t getSelectTime(void) { return 0; }
+#endif
+
+	/**
+	 \fn void strong_pullup(uint16_t ms)
+	 \brief Keeps the strong pullup on for \c ms milliseconds, then releases it.
+	 \details Call this right after the byte written with \c power set to \c 1 (Convert T, Copy Scratchpad, etc.).
+	 Until the window is over, \c reset(), \c read(), \c write() and the bit functions wait for it to end, so
+	 that no slot cuts the power of parasite devices. Devices having their own power supply and started by the
+	 same broadcast command work in parallel during the window.
+	 @param ms Length of the window, in milliseconds.
+	 \remark The window belongs to this object: other objects driving the same pin do not see it.
+	 @see pullup_active, pullup_wait
+	 */
+    void strong_pullup(uint16_t ms);
+	/**
+	 \fn bool pullup_active(void)
+	 \brief Returns \c True while the strong pullup window is running. The pullup is released as soon as
+	 this is called after the end of the window.
+	 */
+    bool pullup_active(void);
+	/**
+	 \fn void pullup_wait(void)
+	 \brief Waits until the strong pullup window is over and releases the pullup.
+	 */
+    void pullup_wait(void);
+
+	/**
+	 \fn uint16_t execute(const OWtransaction *t, uint8_t *rom = NULL, uint8_t *buf = NULL, uint8_t flags = 0)
+	 \brief Executes the transaction \c t.
+	 \details The steps are performed in this order: reset, SKIP ROM or \c address(rom), command bytes, \c t->writeLen
+	 bytes from \c buf, then \c t->readLen bytes read into \c buf and checked against their CRC if requested.
+	 @param t Transaction to execute.
+	 @param rom Address of the device, used with \c OW_TXN_MATCH only.
+	 @param buf Buffer holding the bytes to write, then receiving the bytes read. It can be \c NULL if there are none.
+	 @param flags Flags added to those of \c t for this execution only (\c OW_TXN_PULLUP for parasite powered devices,
+	 for example).
+	 \return \c ERROR_NONE on success, the error code raised otherwise. \c ERROR_NOT_SUPPORTED is returned, before
+	 any bus access, if \c t asks for a CRC check disabled by \c ONEWIRE_CRC or \c ONEWIRE_CRC16.
+	 */
+    uint16_t execute(const OWtransaction *t, uint8_t *rom = NULL, uint8_t *buf = NULL, uint8_t flags = 0);
+	/**
+	 \fn uint16_t execute_P(const OWtransaction *t, uint8_t *rom = NULL, uint8_t *buf = NULL, uint8_t flags = 0)
+	 \brief Same as \c execute() for a transaction stored in flash (declared \c PROGMEM).
+	 */
+    uint16_t execute_P(const OWtransaction *t, uint8_t *rom = NULL, uint8_t *buf = NULL, uint8_t flags = 0);
+
+	/**
+	 \fn void getStats(OWstats *s)
+	 \brief Copies the health counters of the bus into \c s.
+	 \details Presence failures and shorts point to cabling problems, CRC errors and search restarts to marginal
+	 signal quality. All fields stay at 0 if \c ONEWIRE_STATS is defined to 0.
+	 @param s Destination of the snapshot.
+	 @see clearStats
+	 */
+    void getStats(OWstats *s);
+	/**
+	 \fn void clearStats(void)
+	 \brief Sets all the health counters back to 0.
+	 */
+    void clearStats(void);
+
 #if ONEWIRE_SEARCH
 	/**
 	 \fn void reset_search(void)
@@ -247,6 +773,65 @@ public:
 	 deterministic. You will always get the same devices in the same order.
 	 */
     bool search(uint8_t *newAddr, uint8_t searchCmd);
+
+	/**
+	 \fn void search_command(uint8_t searchCmd)
+	 \brief Issues a search command, you do the reset first. Use this together with \c triplet() to run the
+	 search algorithm step by step.
+	 @param searchCmd Either \c CMD_GENERIC_SEARCH or \c CMD_ALARM_SEARCH.
+	 */
+    void search_command(uint8_t searchCmd);
+	/**
+	 \fn uint8_t triplet(uint8_t direction)
+	 \brief Performs one step of the search algorithm: reads a bit and its complement, then writes the search
+	 direction.
+	 @param direction Direction to take if the bit and its complement are both 0 (a discrepancy).
+	 \return Bit 0 is the bit read, bit 1 its complement and bit 2 the direction taken. If both bits read are 1
+	 (no device) nothing is written.
+	 */
+    uint8_t triplet(uint8_t direction);
+
+	/**
+	 \fn void target_search(uint8_t family)
+	 \brief Setup the search state so that the next call to \c search() finds the first device of family \c family.
+	 @param family Family code of the devices to look for (\c FAM_CODE_DB18B20, for example).
+	 \remark If no device of that family is on the bus, \c search() returns the first device of the following family.
+	 Always check the family code of the address returned.
+	 @see search_family
+	 */
+    void target_search(uint8_t family);
+
+	/**
+	 \fn void skip_family(void)
+	 \brief Setup the search state so that the next call to \c search() skips all the remaining devices having the
+	 same family code as the last device found.
+	 \details Uses the last family discrepancy recorded by the previous \c search(), so that unrelated families are
+	 skipped in one pass instead of being enumerated device by device.
+	 */
+    void skip_family(void);
+
+	/**
+	 \fn bool search_family(uint8_t *newAddr, uint8_t family, uint8_t searchCmd = CMD_GENERIC_SEARCH)
+	 \brief Look for the next device having family code \c family.
+	 @param newAddr Address of the newly found device
+	 @param family Family code of the devices to look for.
+	 @param searchCmd Type of search to perform (\c CMD_GENERIC_SEARCH or \c CMD_ALARM_SEARCH).
+	 \return Returns \c True if a new address has been returned. \c False means that all the devices of
+	 that family have been retrieved (or that there are none). The search state is then reset so that the next
+	 call starts over.
+	 */
+    bool search_family(uint8_t *newAddr, uint8_t family, uint8_t searchCmd = CMD_GENERIC_SEARCH);
+
+	/**
+	 \fn bool verify(uint8_t rom[8])
+	 \brief Checks if the device having address \c rom is present on the bus.
+	 \details Performs a single search pass preset on \c rom. This is much faster than enumerating all the
+	 devices on the bus. The current search state is saved and restored, so this can be called in the middle
+	 of an enumeration.
+	 @param rom Address of the device to look for.
+	 \return Returns \c True if the device is present, \c False otherwise.
+	 */
+    bool verify(uint8_t rom[8]);
 #endif
 	
 #if ONEWIRE_CRC
@@ -259,6 +844,31 @@ public:
 	 */
     static uint8_t crc8( uint8_t *addr, uint8_t len);
 
+	/**
+	 \fn static uint8_t crc8_update(uint8_t crc, uint8_t data)
+	 \brief Updates a running Dallas Semiconductor 8 bit CRC with one more byte.
+	 @param crc CRC of the bytes before \c data (\c 0 for the first byte).
+	 @param data Next byte.
+	 \return The CRC including \c data.
+	 */
+    static uint8_t crc8_update(uint8_t crc, uint8_t data);
+
+	/**
+	 \fn bool read_bytes_crc8(uint8_t *buf, uint16_t count, const uint8_t *expect = NULL, const uint8_t *mask = NULL)
+	 \brief Reads \c count bytes, the last one being an 8 bit CRC, and checks them while reading.
+	 \details The CRC is updated after each byte, between two slots, so that the result is known as soon as the
+	 last byte arrives. If \c expect and \c mask are given, each byte is compared with the expected one on the
+	 bits set in the mask. On the first mismatch the transfer is aborted with a reset and \c ERROR_READ_FAILURE is
+	 raised. A CRC mismatch raises \c ERROR_INVALID_CRC.
+	 @param buf Buffer for storing the data read (CRC byte included).
+	 @param count Number of bytes to read, CRC byte included.
+	 @param expect Expected value of each byte (\c count entries), or \c NULL.
+	 @param mask Bits of each byte which have to match \c expect (\c count entries), or \c NULL. Ignored if \c expect
+	 is \c NULL.
+	 \return \c True if the CRC matches, \c False otherwise.
+	 */
+    bool read_bytes_crc8(uint8_t *buf, uint16_t count, const uint8_t *expect = NULL, const uint8_t *mask = NULL);
+
 #if ONEWIRE_CRC16
 	/**
 	 \fn bool check_crc16(uint8_t* input, uint16_t len, uint8_t* inverted_crc)
@@ -282,11 +892,12 @@ public:
     @param input - Array of bytes to checksum.
     @param len - How many bytes to use.
     @param inverted_crc - The two CRC16 bytes in the received data. This should just point into the received data, *not* at a 16-bit integer.
+    @param crc - The CRC16 of the bytes preceding \c input (\c 0 if none).
     @return True, iff the CRC matches.
 	 */
-    static bool check_crc16(uint8_t* input, uint16_t len, uint8_t* inverted_crc);
+    static bool check_crc16(uint8_t* input, uint16_t len, uint8_t* inverted_crc, uint16_t crc = 0);
 	/**
-	 \fn static uint16_t crc16(uint8_t* input, uint16_t len)
+	 \fn static uint16_t crc16(uint8_t* input, uint16_t len, uint16_t crc = 0)
 	 \brief Compute a Dallas Semiconductor 16 bit CRC.  
 	 \details Compute a Dallas Semiconductor 16 bit CRC. This is required to check the integrity of data received from many 
 	 1-Wire devices.  Note that the CRC computed here is *not* what you'll get from the 1-Wire network, for two reasons:
@@ -297,9 +908,55 @@ public:
      byte order than the two bytes you get from 1-Wire.
      @param input - Array of bytes to checksum.
 	 @param len - How many bytes to use.
+	 @param crc - The CRC16 of the bytes preceding \c input (\c 0 if none).
 	 @return The CRC16, as defined by Dallas Semiconductor.
 	 */
-    static uint16_t crc16(uint8_t* input, uint16_t len);
+    static uint16_t crc16(uint8_t* input, uint16_t len, uint16_t crc = 0);
+
+	/**
+	 \fn static uint16_t crc16_update(uint16_t crc, uint8_t data)
+	 \brief Updates a running Dallas Semiconductor 16 bit CRC with one more byte.
+	 @param crc CRC of the bytes before \c data (\c 0 for the first byte).
+	 @param data Next byte.
+	 \return The CRC including \c data.
+	 */
+    static uint16_t crc16_update(uint16_t crc, uint8_t data);
+
+	/**
+	 \fn uint16_t write_bytes_crc16(const uint8_t *buf, uint16_t count, uint16_t crc = 0, bool power = 0)
+	 \brief Writes \c count bytes from \c buf and computes their CRC16 while writing.
+	 @param buf Buffer containing the data to be written.
+	 @param count Number of bytes to be written.
+	 @param crc CRC16 of the bytes sent before (\c 0 if none).
+	 @param power See \c write_bytes().
+	 \return The CRC16 including the bytes written, to be passed to \c read_bytes_crc16().
+	 */
+    uint16_t write_bytes_crc16(const uint8_t *buf, uint16_t count, uint16_t crc = 0, bool power = 0);
+
+	/**
+	 \fn bool read_bytes_crc16(uint8_t *buf, uint16_t count, uint16_t crc = 0, const uint8_t *expect = NULL, const uint8_t *mask = NULL)
+	 \brief Reads \c count bytes, the last two being an inverted CRC16, and checks them while reading.
+	 \details Same as \c read_bytes_crc8() for devices protecting their data with a CRC16. The CRC usually
+	 covers the command bytes too, pass the value returned by \c write_bytes_crc16() in this case.
+	 \par Example usage (reading a DS2408):
+	 \par
+	 <code>
+        uint8_t cmd[3] = { 0xF0, 0x88, 0x00 };  // Read PIO Registers from 0x0088<br/>
+        uint8_t buf[10];<br/>
+        uint16_t crc = write_bytes_crc16(cmd, 3);<br/>
+        if (!read_bytes_crc16(buf, 10, crc)) {<br/>
+        &nbsp;&nbsp;    // Handle error.<br/>
+        }<br/>
+	 </code>
+	 @param buf Buffer for storing the data read (CRC bytes included).
+	 @param count Number of bytes to read, CRC bytes included.
+	 @param crc CRC16 of the bytes sent before (\c 0 if none).
+	 @param expect Expected value of each byte (\c count entries), or \c NULL.
+	 @param mask Bits of each byte which have to match \c expect (\c count entries), or \c NULL. Ignored if \c expect
+	 is \c NULL.
+	 \return \c True if the CRC matches, \c False otherwise.
+	 */
+    bool read_bytes_crc16(uint8_t *buf, uint16_t count, uint16_t crc = 0, const uint8_t *expect = NULL, const uint8_t *mask = NULL);
 #endif
 #endif
 };
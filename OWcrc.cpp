@@ -0,0 +1,131 @@
+/**
+ \file OWcrc.cpp
+ \brief Implementation of the OWcrc class.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+// The 1-Wire CRC scheme is described in Maxim Application Note 27:
+// "Understanding and Using Cyclic Redundancy Checks with Maxim iButton Products"
+// Both CRCs are computed LSB first, so that the tables below are indexed
+// by the low byte of (crc ^ data).
+
+#include "OWcrc.h"
+
+// Entries of the nibble tables: the CRC being linear, the table entry of
+// a byte is the XOR of the entries of its two nibbles
+#define OWCRC8_LO(i)  OWcrc8_entry(i)
+#define OWCRC8_HI(i)  OWcrc8_entry((i) << 4)
+#define OWCRC16_LO(i) OWcrc16_entry(i)
+#define OWCRC16_HI(i) OWcrc16_entry((i) << 4)
+
+static const uint8_t PROGMEM crc8_lo[16] = { OWCRC_T16(OWCRC8_LO, 0) };
+static const uint8_t PROGMEM crc8_hi[16] = { OWCRC_T16(OWCRC8_HI, 0) };
+static const uint8_t PROGMEM crc8_tab[256] = { OWCRC_T256(OWcrc8_entry) };
+
+static const uint16_t PROGMEM crc16_lo[16] = { OWCRC_T16(OWCRC16_LO, 0) };
+static const uint16_t PROGMEM crc16_hi[16] = { OWCRC_T16(OWCRC16_HI, 0) };
+static const uint16_t PROGMEM crc16_tab[256] = { OWCRC_T256(OWcrc16_entry) };
+
+uint8_t OWcrc::crc8_bitwise(uint8_t crc, uint8_t data)
+{
+	for (uint8_t i = 8; i; i--) {
+		uint8_t mix = (crc ^ data) & 0x01;
+		crc >>= 1;
+		if (mix) crc ^= 0x8C;
+		data >>= 1;
+	}
+	return crc;
+}
+
+uint8_t OWcrc::crc8_nibble(uint8_t crc, uint8_t data)
+{
+	crc ^= data;
+	return pgm_read_byte(crc8_lo + (crc & 0x0F)) ^ pgm_read_byte(crc8_hi + (crc >> 4));
+}
+
+uint8_t OWcrc::crc8_table(uint8_t crc, uint8_t data)
+{
+	return pgm_read_byte(crc8_tab + (crc ^ data));
+}
+
+uint16_t OWcrc::crc16_bitwise(uint16_t crc, uint8_t data)
+{
+	for (uint8_t i = 8; i; i--) {
+		uint8_t mix = (crc ^ data) & 0x01;
+		crc >>= 1;
+		if (mix) crc ^= 0xA001;
+		data >>= 1;
+	}
+	return crc;
+}
+
+uint16_t OWcrc::crc16_parity(uint16_t crc, uint8_t data)
+{
+	static const uint8_t oddparity[16] =
+		{ 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0 };
+
+	// Even though we're just copying a byte from the input,
+	// we'll be doing 16-bit computation with it.
+	uint16_t cdata = data;
+	cdata = (cdata ^ (crc & 0xff)) & 0xff;
+	crc >>= 8;
+
+	if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
+		crc ^= 0xC001;
+
+	cdata <<= 6;
+	crc ^= cdata;
+	cdata <<= 1;
+	crc ^= cdata;
+
+	return crc;
+}
+
+uint16_t OWcrc::crc16_nibble(uint16_t crc, uint8_t data)
+{
+	uint8_t x = (crc ^ data) & 0xFF;
+
+	return (crc >> 8) ^ pgm_read_word(crc16_lo + (x & 0x0F)) ^ pgm_read_word(crc16_hi + (x >> 4));
+}
+
+uint16_t OWcrc::crc16_table(uint16_t crc, uint8_t data)
+{
+	return (crc >> 8) ^ pgm_read_word(crc16_tab + ((crc ^ data) & 0xFF));
+}
+
+#if ONEWIRE_CRC16_SLICE4
+#define OWCRC16_S1(i) OWcrc16_slice(1, i)
+#define OWCRC16_S2(i) OWcrc16_slice(2, i)
+#define OWCRC16_S3(i) OWcrc16_slice(3, i)
+
+static const uint16_t PROGMEM crc16_s1[256] = { OWCRC_T256(OWCRC16_S1) };
+static const uint16_t PROGMEM crc16_s2[256] = { OWCRC_T256(OWCRC16_S2) };
+static const uint16_t PROGMEM crc16_s3[256] = { OWCRC_T256(OWCRC16_S3) };
+
+//
+// Four bytes per step: after two bytes the old CRC has been shifted out
+// entirely, so each byte contributes one lookup in the table matching
+// the number of bytes following it.
+//
+uint16_t OWcrc::crc16_slice4(const uint8_t *buf, uint32_t len, uint16_t crc)
+{
+	while (len >= 4) {
+		crc ^= buf[0] | (buf[1] << 8);
+		crc = pgm_read_word(crc16_s3 + (crc & 0xFF)) ^ pgm_read_word(crc16_s2 + (crc >> 8)) ^
+		      pgm_read_word(crc16_s1 + buf[2]) ^ pgm_read_word(crc16_tab + buf[3]);
+		buf += 4;
+		len -= 4;
+	}
+	while (len--)
+		crc = crc16_table(crc, *buf++);
+
+	return crc;
+}
+#endif
@@ -0,0 +1,177 @@
+/**
+ \file OWcrc.h
+ \brief Definition of the OWcrc class.
+ \details Header file containing the CRC8 and CRC16 kernels used on the 1-Wire bus. The lookup tables are
+ generated at compile time, nothing here depends on the Arduino core so that the kernels can also be built
+ and compared on a host (see \c extras/crcbench).
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef OWCRC_H
+#define OWCRC_H
+
+#include <inttypes.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#endif
+
+/**
+ \name CRC kernels
+ \brief Macro definitions for the CRC kernels, to be used with \c ONEWIRE_CRC8_KERNEL and \c ONEWIRE_CRC16_KERNEL.
+ \remark Flash used by the tables: 0 bytes for the bitwise kernel, 32 (CRC8) or 64 (CRC16) for the nibble
+ kernels, 256 (CRC8) or 512 (CRC16) for the table kernels, 16 for the parity kernel.
+ */
+//@{
+/**
+ \def OW_CRC_KERNEL_BITWISE 0
+ \brief One shift per bit, no table. Smallest and slowest.
+ */
+#define OW_CRC_KERNEL_BITWISE 0
+/**
+ \def OW_CRC_KERNEL_NIBBLE 1
+ \brief Two lookups per byte in 16 entries tables.
+ */
+#define OW_CRC_KERNEL_NIBBLE 1
+/**
+ \def OW_CRC_KERNEL_TABLE 2
+ \brief One lookup per byte in a 256 entries table. Largest and fastest.
+ */
+#define OW_CRC_KERNEL_TABLE 2
+/**
+ \def OW_CRC_KERNEL_PARITY 3
+ \brief CRC16 only: parity of the input byte plus a few shifts.
+ */
+#define OW_CRC_KERNEL_PARITY 3
+//@}
+
+// Slicing-by-4 needs 2 KB of tables: only meant for hosts
+#ifndef ONEWIRE_CRC16_SLICE4
+#if defined(__AVR__)
+#define ONEWIRE_CRC16_SLICE4 0
+#else
+#define ONEWIRE_CRC16_SLICE4 1
+#endif
+#endif
+
+/**
+ \name Compile time table generation
+ */
+//@{
+/**
+ \fn constexpr uint8_t OWcrc8_shift(uint8_t crc, uint8_t n)
+ \brief Shifts \c n zero bits into the CRC8 \c crc (polynomial X^8 + X^5 + X^4 + 1).
+ */
+constexpr uint8_t OWcrc8_shift(uint8_t crc, uint8_t n) {
+	return n ? OWcrc8_shift((crc & 1) ? (crc >> 1) ^ 0x8C : (crc >> 1), n - 1) : crc;
+}
+/**
+ \fn constexpr uint8_t OWcrc8_entry(uint8_t i)
+ \brief Entry \c i of the CRC8 lookup table.
+ */
+constexpr uint8_t OWcrc8_entry(uint8_t i) { return OWcrc8_shift(i, 8); }
+/**
+ \fn constexpr uint16_t OWcrc16_shift(uint16_t crc, uint8_t n)
+ \brief Shifts \c n zero bits into the CRC16 \c crc (polynomial X^16 + X^15 + X^2 + 1).
+ */
+constexpr uint16_t OWcrc16_shift(uint16_t crc, uint8_t n) {
+	return n ? OWcrc16_shift((crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1), n - 1) : crc;
+}
+/**
+ \fn constexpr uint16_t OWcrc16_entry(uint8_t i)
+ \brief Entry \c i of the CRC16 lookup table.
+ */
+constexpr uint16_t OWcrc16_entry(uint8_t i) { return OWcrc16_shift(i, 8); }
+/**
+ \fn constexpr uint16_t OWcrc16_slice(uint8_t k, uint8_t i)
+ \brief Entry \c i of the CRC16 lookup table followed by \c k zero bytes (slicing tables).
+ */
+constexpr uint16_t OWcrc16_slice(uint8_t k, uint8_t i) {
+	return k ? (OWcrc16_slice(k - 1, i) >> 8) ^ OWcrc16_entry(OWcrc16_slice(k - 1, i) & 0xFF) : OWcrc16_entry(i);
+}
+
+// Expand f(0), f(1), ..., f(n-1) inside a table initializer
+#define OWCRC_T4(f, i)   f(i), f(i + 1), f(i + 2), f(i + 3)
+#define OWCRC_T16(f, i)  OWCRC_T4(f, i), OWCRC_T4(f, i + 4), OWCRC_T4(f, i + 8), OWCRC_T4(f, i + 12)
+#define OWCRC_T64(f, i)  OWCRC_T16(f, i), OWCRC_T16(f, i + 16), OWCRC_T16(f, i + 32), OWCRC_T16(f, i + 48)
+#define OWCRC_T256(f)    OWCRC_T64(f, 0), OWCRC_T64(f, 64), OWCRC_T64(f, 128), OWCRC_T64(f, 192)
+//@}
+
+/**
+ \class OWcrc OWcrc.h
+ \brief CRC kernels for the 1-Wire bus.
+
+ All the kernels compute the same CRCs, they only trade flash for speed. \c OWcomponent uses the ones selected
+ by \c ONEWIRE_CRC8_KERNEL and \c ONEWIRE_CRC16_KERNEL, unused kernels (and their tables) are discarded by the
+ linker.
+ */
+class OWcrc {
+public:
+	/**
+	 \fn static uint8_t crc8_bitwise(uint8_t crc, uint8_t data)
+	 \brief Updates the CRC8 \c crc with the byte \c data, one bit at a time.
+	 */
+	static uint8_t crc8_bitwise(uint8_t crc, uint8_t data);
+	/**
+	 \fn static uint8_t crc8_nibble(uint8_t crc, uint8_t data)
+	 \brief Updates the CRC8 \c crc with the byte \c data, using two 16 entries tables.
+	 */
+	static uint8_t crc8_nibble(uint8_t crc, uint8_t data);
+	/**
+	 \fn static uint8_t crc8_table(uint8_t crc, uint8_t data)
+	 \brief Updates the CRC8 \c crc with the byte \c data, using a 256 entries table.
+	 */
+	static uint8_t crc8_table(uint8_t crc, uint8_t data);
+
+	/**
+	 \fn static uint16_t crc16_bitwise(uint16_t crc, uint8_t data)
+	 \brief Updates the CRC16 \c crc with the byte \c data, one bit at a time.
+	 */
+	static uint16_t crc16_bitwise(uint16_t crc, uint8_t data);
+	/**
+	 \fn static uint16_t crc16_parity(uint16_t crc, uint8_t data)
+	 \brief Updates the CRC16 \c crc with the byte \c data, using the parity of the input byte.
+	 */
+	static uint16_t crc16_parity(uint16_t crc, uint8_t data);
+	/**
+	 \fn static uint16_t crc16_nibble(uint16_t crc, uint8_t data)
+	 \brief Updates the CRC16 \c crc with the byte \c data, using two 16 entries tables.
+	 */
+	static uint16_t crc16_nibble(uint16_t crc, uint8_t data);
+	/**
+	 \fn static uint16_t crc16_table(uint16_t crc, uint8_t data)
+	 \brief Updates the CRC16 \c crc with the byte \c data, using a 256 entries table.
+	 */
+	static uint16_t crc16_table(uint16_t crc, uint8_t data);
+
+#if ONEWIRE_CRC16_SLICE4
+	/**
+	 \fn static uint16_t crc16_slice4(const uint8_t *buf, uint32_t len, uint16_t crc = 0)
+	 \brief Computes the CRC16 of a whole buffer, four bytes at a time (slicing-by-4).
+	 \details Meant for bulk verification on a host, for example of EEPROM dumps: it uses 2 KB of tables.
+	 @param buf Data buffer.
+	 @param len Length of the buffer.
+	 @param crc CRC16 of the bytes preceding \c buf (\c 0 if none).
+	 \return The CRC16 including \c buf.
+	 */
+	static uint16_t crc16_slice4(const uint8_t *buf, uint32_t len, uint16_t crc = 0);
+#endif
+};
+
+#endif
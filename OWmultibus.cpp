@@ -0,0 +1,181 @@
+/**
+ \file OWmultibus.cpp
+ \brief Implementation of the OWmultibus class.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "OWmultibus.h"
+
+//
+// Transpose an 8x8 bit matrix: bit i of out[j] is bit j of in[i]
+//
+static void transpose(const uint8_t *in, uint8_t *out)
+{
+	uint8_t i, j;
+
+	for (j = 0; j < 8; j++) {
+		uint8_t r = 0;
+		for (i = 0; i < 8; i++)
+			if (in[i] & (1 << j))
+				r |= (1 << i);
+		out[j] = r;
+	}
+}
+
+OWmultibus::OWmultibus(const uint8_t port, const uint8_t mask) {
+	_baseReg = portInputRegister(port);
+	_mask = mask;
+	OWcomponent::defaultTiming(OW_SPEED_STANDARD, &_timing);
+
+	noInterrupts();
+	DIRECT_MODE_INPUT(_baseReg, _mask);
+	DIRECT_WRITE_LOW(_baseReg, _mask);
+	interrupts();
+}
+
+//
+// Reset all the buses at once. Buses which do not come high within
+// 250uS are left out.
+//
+uint8_t OWmultibus::reset(void)
+{
+	IO_REG_TYPE mask = _mask;
+	volatile IO_REG_TYPE *reg IO_REG_ASM = _baseReg;
+	uint8_t r;
+	uint8_t retries = 125;
+
+	noInterrupts();
+	DIRECT_MODE_INPUT(reg, mask);
+	interrupts();
+	// wait until the wires are high... just in case
+	while (DIRECT_READ_MASK(reg, mask) != mask) {
+		if (--retries == 0) break;
+		delayMicroseconds(2);
+	}
+	mask = DIRECT_READ_MASK(reg, mask);
+	if (!mask) return 0;
+
+	noInterrupts();
+	DIRECT_WRITE_LOW(reg, mask);
+	DIRECT_MODE_OUTPUT(reg, mask);	// drive outputs low
+	interrupts();
+	delayMicroseconds(_timing.resetLow);
+	noInterrupts();
+	DIRECT_MODE_INPUT(reg, mask);	// allow them to float
+	delayMicroseconds(_timing.presenceSample);
+	r = ~DIRECT_READ_MASK(reg, mask) & mask;
+	interrupts();
+	delayMicroseconds(_timing.resetRecovery);
+	return r;
+}
+
+//
+// Write one bit on every bus. All the buses are pulled low together,
+// the ones getting a 1 are released early.
+//
+void OWmultibus::write_bits(uint8_t v)
+{
+	IO_REG_TYPE mask = _mask;
+	IO_REG_TYPE ones = v & mask;
+	volatile IO_REG_TYPE *reg IO_REG_ASM = _baseReg;
+	uint8_t low1 = _timing.write1Low;
+	uint8_t low0 = _timing.write0Low - _timing.write1Low;
+
+	noInterrupts();
+	DIRECT_WRITE_LOW(reg, mask);
+	DIRECT_MODE_OUTPUT(reg, mask);	// drive outputs low
+	delayMicroseconds(low1);
+	DIRECT_WRITE_HIGH(reg, ones);	// end of the write 1 slots
+	delayMicroseconds(low0);
+	DIRECT_WRITE_HIGH(reg, mask);	// end of the write 0 slots
+	interrupts();
+	delayMicroseconds(_timing.write0Recovery);
+}
+
+//
+// Read one bit from every bus with a single sample of the port
+//
+uint8_t OWmultibus::read_bits(void)
+{
+	IO_REG_TYPE mask = _mask;
+	volatile IO_REG_TYPE *reg IO_REG_ASM = _baseReg;
+	uint8_t low = _timing.readLow, sample = _timing.readSample;
+	uint8_t r;
+
+	noInterrupts();
+	DIRECT_MODE_OUTPUT(reg, mask);
+	DIRECT_WRITE_LOW(reg, mask);
+	delayMicroseconds(low);
+	DIRECT_MODE_INPUT(reg, mask);	// let pins float, pull ups will raise
+	delayMicroseconds(sample);
+	r = DIRECT_READ_MASK(reg, mask);
+	interrupts();
+	delayMicroseconds(_timing.readRecovery);
+	return r;
+}
+
+void OWmultibus::write(uint8_t v, uint8_t power /* = 0 */)
+{
+	uint8_t bitMask;
+
+	for (bitMask = 0x01; bitMask; bitMask <<= 1)
+		write_bits((v & bitMask) ? _mask : 0);
+	if (!power)
+		depower();
+}
+
+void OWmultibus::write(const uint8_t *v, uint8_t power /* = 0 */)
+{
+	uint8_t slots[8];
+	uint8_t i;
+
+	// slots[b] holds bit b of every bus
+	transpose(v, slots);
+	for (i = 0; i < 8; i++)
+		write_bits(slots[i]);
+	if (!power)
+		depower();
+}
+
+void OWmultibus::read(uint8_t *v)
+{
+	uint8_t slots[8];
+	uint8_t i;
+
+	for (i = 0; i < 8; i++)
+		slots[i] = read_bits();
+	transpose(slots, v);
+}
+
+void OWmultibus::skip(void)
+{
+	write(CMD_SKIP_ROM);
+}
+
+void OWmultibus::select(uint8_t rom[][8])
+{
+	uint8_t tmp[8];
+	uint8_t i, k;
+
+	write(CMD_MATCH_ROM);
+	for (k = 0; k < 8; k++) {
+		for (i = 0; i < 8; i++)
+			tmp[i] = rom[i][k];
+		write(tmp);
+	}
+}
+
+void OWmultibus::depower(void)
+{
+	noInterrupts();
+	DIRECT_MODE_INPUT(_baseReg, _mask);
+	DIRECT_WRITE_LOW(_baseReg, _mask);
+	interrupts();
+}
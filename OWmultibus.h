@@ -0,0 +1,116 @@
+/**
+ \file OWmultibus.h
+ \brief Definition of the OWmultibus class.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+/**
+ \class OWmultibus OWmultibus.h
+ \brief Class for driving up to 8 independent 1-Wire buses wired on the pins of the same port.
+
+ All the buses run the same slot at the same time: one register write drives every bus and one register
+ read samples every bus. Each bus can still send its own data, since a write slot only differs in the time
+ the line is released. Per-bus data is passed as arrays of 8 bytes indexed by the bit number of the pin in
+ the port (bus \c i is the pin having bit mask \c 1<<i). Entries of buses not in the mask are ignored.
+
+ Typical use is to start a conversion on all the DS18B20 chains at once, and then to read one sensor from
+ each chain in parallel.
+ */
+
+#ifndef OWMULTIBUS_H
+#define OWMULTIBUS_H
+
+#include "OWcomponent.h"
+
+class OWmultibus : public Error {
+
+private:
+	IO_REG_TYPE _mask;
+	volatile IO_REG_TYPE *_baseReg;
+	OWtiming _timing;
+
+public:
+	/**
+	 \fn OWmultibus(const uint8_t port, const uint8_t mask)
+	 \brief Constructor
+	 @param port Arduino port the buses are wired on (as returned by \c digitalPinToPort()).
+	 @param mask Bit mask of the pins of the port which are 1-Wire buses.
+	 */
+	OWmultibus(const uint8_t port, const uint8_t mask);
+
+	/**
+	 \fn uint8_t getMask(void)
+	 \brief Returns the bit mask of the buses driven.
+	 */
+	inline uint8_t getMask(void) { return _mask; }
+
+	/**
+	 \fn uint8_t reset(void)
+	 \brief Performs a 1-Wire reset cycle on all the buses.
+	 \return The bit mask of the buses on which at least one device responded with a presence pulse.
+	 Buses shorted or held low for more than 250uS are never in the result.
+	 */
+	uint8_t reset(void);
+
+	/**
+	 \fn void write_bits(uint8_t v)
+	 \brief Writes one bit on each bus.
+	 @param v Bit mask of the buses on which a 1 is written. A 0 is written on the others.
+	 */
+	void write_bits(uint8_t v);
+	/**
+	 \fn uint8_t read_bits(void)
+	 \brief Reads one bit from each bus.
+	 \return Bit mask of the buses on which a 1 has been read.
+	 */
+	uint8_t read_bits(void);
+
+	/**
+	 \fn void write(uint8_t v, uint8_t power = 0)
+	 \brief Writes the same byte on all the buses.
+	 @param v Byte to write.
+	 @param power Set to \c 1 to leave the buses powered at the end. See \c OWcomponent::write().
+	 */
+	void write(uint8_t v, uint8_t power = 0);
+	/**
+	 \fn void write(const uint8_t *v, uint8_t power = 0)
+	 \brief Writes a different byte on each bus.
+	 @param v Array of 8 bytes, \c v[i] is written on bus \c i.
+	 @param power Set to \c 1 to leave the buses powered at the end. See \c OWcomponent::write().
+	 */
+	void write(const uint8_t *v, uint8_t power = 0);
+	/**
+	 \fn void read(uint8_t *v)
+	 \brief Reads one byte from each bus.
+	 @param v Array of 8 bytes, \c v[i] receives the byte read on bus \c i.
+	 */
+	void read(uint8_t *v);
+
+	/**
+	 \fn void skip(void)
+	 \brief Issues a 1-Wire rom skip command on all the buses.
+	 */
+	void skip(void);
+	/**
+	 \fn void select(uint8_t rom[][8])
+	 \brief Issues a 1-Wire rom select command on all the buses, selecting a different device on each of them.
+	 @param rom Array of 8 addresses, \c rom[i] is selected on bus \c i.
+	 */
+	void select(uint8_t rom[][8]);
+
+	/**
+	 \fn void depower(void)
+	 \brief Stop forcing power onto the buses.
+	 @see OWcomponent::depower()
+	 */
+	void depower(void);
+};
+
+#endif
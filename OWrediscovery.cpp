@@ -0,0 +1,172 @@
+/**
+ \file OWrediscovery.cpp
+ \brief Implementation of the OWrediscovery class.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "OWrediscovery.h"
+
+#if ONEWIRE_SEARCH && ONEWIRE_CRC
+
+OWrediscovery::OWrediscovery(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max, uint8_t count) {
+	_bus = &bus;
+	_roms = roms;
+	_max = (max > OW_REDISCOVERY_MAX) ? OW_REDISCOVERY_MAX : max;
+	_count = (count > _max) ? _max : count;
+	_added = NULL;
+	_removed = NULL;
+	restart();
+}
+
+void OWrediscovery::restart(void) {
+	_bit = 0;
+	abortSweep();
+}
+
+uint8_t OWrediscovery::indexOf(const uint8_t rom[8]) {
+	uint8_t i;
+
+	for (i = 0; i < _count; i++)
+		if (!memcmp(_roms[i], rom, 8))
+			return i;
+	return 0xFF;
+}
+
+//
+// Same algorithm as OWcomponent::search(), but it stops after 'steps'
+// bits and goes on from there at the next call
+//
+bool OWrediscovery::poll(uint8_t steps) {
+	uint8_t t, dir, mask, i;
+
+	// the bus cannot be used while parasite devices are powered
+	if (_bus->pullup_active())
+		return false;
+
+	// somebody else reset the bus: the devices lost track of our pass
+	if (_bit && _bus->getEpoch() != _epoch)
+		_bit = 0;
+
+	if (!_bit) {
+		if (!_bus->reset()) {
+			// no device at all
+			endSweep();
+			return true;
+		}
+		_bus->search_command(CMD_GENERIC_SEARCH);
+		_epoch = _bus->getEpoch();
+		_bit = 1;
+		_lastZero = 0;
+	}
+
+	while (steps--) {
+		i = (_bit - 1) >> 3;
+		mask = 1 << ((_bit - 1) & 7);
+
+		// same choice as the previous pass before the last discrepancy,
+		// the other branch at the last discrepancy, 0 after it
+		if (_bit < _lastDiscrepancy)
+			dir = (_rom[i] & mask) ? 1 : 0;
+		else
+			dir = (_bit == _lastDiscrepancy);
+
+		t = _bus->triplet(dir);
+		if ((t & 0x03) == 0x03) {
+			// all the devices left in the middle of the pass
+			_bit = 0;
+			abortSweep();
+			return false;
+		}
+
+		dir = (t >> 2) & 0x01;
+		if (!(t & 0x03) && !dir)
+			_lastZero = _bit;
+		if (dir)
+			_rom[i] |= mask;
+		else
+			_rom[i] &= ~mask;
+
+		if (++_bit > 64)
+			return found();
+	}
+	return false;
+}
+
+//
+// A pass is over: record the device found
+//
+bool OWrediscovery::found(void) {
+	uint8_t i;
+
+	_bit = 0;
+	if (!_rom[0] || OWcomponent::crc8(_rom, 7) != _rom[7]) {
+		// garbage: the path followed is not reliable, start over
+		setError(ERROR_INVALID_CRC);
+		abortSweep();
+		return false;
+	}
+	_lastDiscrepancy = _lastZero;
+
+	i = indexOf(_rom);
+	if (i == 0xFF) {
+		if (_count < _max) {
+			i = _count++;
+			memcpy(_roms[i], _rom, 8);
+			_seen[i >> 3] |= (1 << (i & 7));
+			if (_added)
+				_added(_roms[i]);
+		}
+		else {
+			setError(ERROR_NO_MORE_ADDRESSES);
+			_overflow = true;
+		}
+	}
+	else
+		_seen[i >> 3] |= (1 << (i & 7));
+
+	if (!_lastDiscrepancy) {
+		endSweep();
+		return true;
+	}
+	return false;
+}
+
+//
+// The whole tree has been walked: the devices not seen are gone
+//
+void OWrediscovery::endSweep(void) {
+	uint8_t i, rom[8];
+
+	for (i = _count; i-- > 0; ) {
+		if (_seen[i >> 3] & (1 << (i & 7)))
+			continue;
+		// the last entry has already been checked, move it here
+		memcpy(rom, _roms[i], 8);
+		_count--;
+		if (i != _count)
+			memcpy(_roms[i], _roms[_count], 8);
+		if (_removed)
+			_removed(rom);
+	}
+
+	// keep the count used by the addressing policy up to date
+	if (!_overflow && _bus->getDeviceCount())
+		_bus->setDeviceCount(_count);
+
+	abortSweep();
+}
+
+void OWrediscovery::abortSweep(void) {
+	memset(_seen, 0, sizeof(_seen));
+	_overflow = false;
+	_lastDiscrepancy = 0;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ \file OWrediscovery.h
+ \brief Definition of the OWrediscovery class.
+ \details Header file containing the definition of the OWrediscovery class (background tracking of the devices on a
+ 1-Wire bus).
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef OWREDISCOVERY_H
+#define OWREDISCOVERY_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "OWcomponent.h"
+
+/**
+ \def OW_REDISCOVERY_MAX 64
+ \brief Maximal number of devices tracked.
+ */
+#define OW_REDISCOVERY_MAX 64
+/**
+ \def OW_REDISCOVERY_STEPS 8
+ \brief Default number of search steps (3 slots each) performed by a call to \c OWrediscovery::poll().
+ */
+#define OW_REDISCOVERY_STEPS 8
+
+/**
+ \typedef void (*OWdeviceHandler)(uint8_t rom[8])
+ \brief Function called by \c OWrediscovery when a device appears or disappears.
+ @param rom Address of the device.
+ */
+typedef void (*OWdeviceHandler)(uint8_t rom[8]);
+
+/**
+ \class OWrediscovery OWrediscovery.h
+ \brief Keeps track of the devices on a 1-Wire bus without stalling the program.
+
+ The search algorithm runs in the background, a few slots at a time, each time \c poll() is called. Each completed
+ sweep of the search tree is compared with the devices known so far: new devices are added to the table and
+ reported, devices not found anymore are removed from the table and reported too. At standard speed a search step
+ takes about 200 microseconds, a complete sweep about 13 ms per device.
+ \remark If some other code resets the bus in the middle of a search pass, the pass starts over (see
+ \c OWcomponent::getEpoch()). Nothing is sent while a strong pullup window is running.
+ */
+
+#if ONEWIRE_SEARCH && ONEWIRE_CRC
+class OWrediscovery : public Error {
+private:
+	/**
+	 \var OWcomponent *_bus
+	 \brief Bus (or backend) to watch.
+	 */
+	OWcomponent *_bus;
+	/**
+	 \var uint8_t (*_roms)[8]
+	 \brief Addresses of the devices known, the storage is provided by the caller.
+	 */
+	uint8_t (*_roms)[8];
+	uint8_t _max, _count;
+	/**
+	 \var uint8_t _seen[OW_REDISCOVERY_MAX / 8]
+	 \brief One bit per known device, set when the current sweep has found it.
+	 */
+	uint8_t _seen[OW_REDISCOVERY_MAX / 8];
+	bool _overflow;
+
+	// state of the search pass in progress
+	uint8_t _rom[8];
+	uint8_t _bit;               // next bit to read (1 to 64), 0 if no pass is in progress
+	uint8_t _lastZero;
+	uint8_t _lastDiscrepancy;
+	uint8_t _epoch;
+
+	OWdeviceHandler _added, _removed;
+
+	bool found(void);
+	void endSweep(void);
+	void abortSweep(void);
+
+public:
+	/**
+	 \fn OWrediscovery(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max, uint8_t count = 0)
+	 \brief Constructor
+	 @param bus Bus to watch.
+	 @param roms Table of the devices known, updated after each sweep.
+	 @param max Number of entries of \c roms (at most \c OW_REDISCOVERY_MAX).
+	 @param count Number of devices already in \c roms (saved from a previous run, for example). They are not
+	 reported as new by the first sweep.
+	 */
+	OWrediscovery(OWcomponent &bus, uint8_t (*roms)[8], uint8_t max, uint8_t count = 0);
+
+	/**
+	 \fn void onAdded(OWdeviceHandler h)
+	 \brief Sets the function called when a new device is found.
+	 */
+	inline void onAdded(OWdeviceHandler h) { _added = h; }
+	/**
+	 \fn void onRemoved(OWdeviceHandler h)
+	 \brief Sets the function called when a device is not found anymore. It has already been removed from the table.
+	 */
+	inline void onRemoved(OWdeviceHandler h) { _removed = h; }
+
+	/**
+	 \fn bool poll(uint8_t steps = OW_REDISCOVERY_STEPS)
+	 \brief Advances the search by at most \c steps bits.
+	 \return \c True if a sweep has been completed by this call (the table is up to date), \c False otherwise.
+	 */
+	bool poll(uint8_t steps = OW_REDISCOVERY_STEPS);
+	/**
+	 \fn void restart(void)
+	 \brief Drops the pass and the sweep in progress, the next \c poll() starts a new sweep.
+	 */
+	void restart(void);
+
+	/**
+	 \fn uint8_t getCount(void)
+	 \brief Returns the number of devices in the table.
+	 \remark Removing a device moves the last one of the table to its place.
+	 */
+	inline uint8_t getCount(void) { return _count; }
+	/**
+	 \fn uint8_t *getAddress(uint8_t i)
+	 \brief Returns the address of the \c i-th device of the table.
+	 */
+	inline uint8_t *getAddress(uint8_t i) { return _roms[i]; }
+	/**
+	 \fn uint8_t indexOf(const uint8_t rom[8])
+	 \brief Returns the index of the device having address \c rom, \c 0xFF if it is not in the table.
+	 */
+	uint8_t indexOf(const uint8_t rom[8]);
+};
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ \file OWuart.cpp
+ \brief Implementation of the OWuart class.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "OWuart.h"
+
+OWuart::OWuart(HardwareSerial &s) : OWcomponent() {
+	_serial = &s;
+	_resetBaud = 9600;
+	_dataBaud = 115200;
+}
+
+void OWuart::begin(void) {
+	_serial->begin(_dataBaud);
+}
+
+void OWuart::encode(uint8_t v, uint8_t *slots) {
+	for (uint8_t i = 0; i < 8; i++, v >>= 1)
+		slots[i] = (v & 1) ? OWUART_SLOT_1 : OWUART_SLOT_0;
+}
+
+uint8_t OWuart::decode(const uint8_t *slots) {
+	uint8_t r = 0;
+
+	for (uint8_t i = 0; i < 8; i++)
+		if (slots[i] == OWUART_SLOT_1)
+			r |= (1 << i);
+	return r;
+}
+
+uint8_t OWuart::presence(uint8_t echo) {
+	// unchanged: nobody pulled the bus low; 0x00: the bus never came back high
+	return (echo != OWUART_RESET && echo != 0x00) ? 1 : 0;
+}
+
+bool OWuart::exchange(const uint8_t *tx, uint8_t *rx, uint8_t n) {
+	uint8_t i;
+	unsigned long start;
+
+	// drop anything left over by a previous exchange
+	while (_serial->available())
+		_serial->read();
+
+	// all the slots go to the transmit buffer at once, the serial
+	// interrupts shift them out while we wait for the echoes
+	_serial->write(tx, n);
+
+	start = millis();
+	for (i = 0; i < n; ) {
+		if (_serial->available()) {
+			rx[i++] = _serial->read();
+			start = millis();
+		}
+		else if (millis() - start > OWUART_TIMEOUT) {
+			setError(ERROR_TIME_OUT);
+			return false;
+		}
+	}
+	return true;
+}
+
+uint8_t OWuart::bus_reset(void) {
+	uint8_t tx = OWUART_RESET, rx;
+	bool ok;
+
+	_serial->flush();
+	_serial->begin(_resetBaud);
+	ok = exchange(&tx, &rx, 1);
+	_serial->flush();
+	_serial->begin(_dataBaud);
+
+	if (!ok)
+		return 0;
+	if (rx == 0x00)
+		count_short();
+	return presence(rx);
+}
+
+void OWuart::bus_write_bit(uint8_t v) {
+	uint8_t tx = v ? OWUART_SLOT_1 : OWUART_SLOT_0, rx;
+
+	exchange(&tx, &rx, 1);
+}
+
+uint8_t OWuart::bus_read_bit(void) {
+	uint8_t tx = OWUART_SLOT_1, rx;
+
+	if (!exchange(&tx, &rx, 1))
+		return 1;
+	return rx == OWUART_SLOT_1;
+}
+
+void OWuart::bus_write(uint8_t v, uint8_t power) {
+	uint8_t slots[8];
+
+	encode(v, slots);
+	if (exchange(slots, slots, 8) && power)
+		setError(ERROR_NOT_SUPPORTED);
+}
+
+uint8_t OWuart::bus_read(void) {
+	uint8_t slots[8];
+
+	encode(0xFF, slots);
+	if (!exchange(slots, slots, 8))
+		return 0xFF;
+	return decode(slots);
+}
+
+void OWuart::bus_depower(void) {
+	// the UART cannot drive a strong pullup: nothing to release
+}
+
+void OWuart::bus_speed(uint8_t speed) {
+	if (speed == OW_SPEED_OVERDRIVE) {
+		_resetBaud = 115200;
+		_dataBaud = 1000000;
+	}
+	else {
+		_resetBaud = 9600;
+		_dataBaud = 115200;
+	}
+	_serial->flush();
+	_serial->begin(_dataBaud);
+}
@@ -0,0 +1,139 @@
+/**
+ \file OWuart.h
+ \brief Definition of the OWuart class.
+ \details Header file containing the definition of the OWuart class (1-Wire bus driven by a UART).
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef OWUART_H
+#define OWUART_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "OWcomponent.h"
+
+/**
+ \name UART slot encoding
+ \brief Macro definitions for the UART bytes used as 1-Wire slots (see Maxim Application Note 214).
+ */
+//@{
+/**
+ \def OWUART_RESET 0xF0
+ \brief Byte sent at reset speed to generate a reset pulse. It comes back unchanged if no device is present.
+ */
+#define OWUART_RESET 0xF0
+/**
+ \def OWUART_SLOT_1 0xFF
+ \brief Byte sent at data speed for a write 1 or a read slot. It comes back unchanged if the bit is a 1.
+ */
+#define OWUART_SLOT_1 0xFF
+/**
+ \def OWUART_SLOT_0 0x00
+ \brief Byte sent at data speed for a write 0 slot.
+ */
+#define OWUART_SLOT_0 0x00
+//@}
+
+/**
+ \def OWUART_TIMEOUT 10
+ \brief Time (in milliseconds) to wait for the echo of a slot before giving up.
+ */
+#define OWUART_TIMEOUT 10
+
+/**
+ \class OWuart OWuart.h
+ \brief 1-Wire bus driven by a hardware UART.
+
+ The UART generates the slots: a reset is a 0xF0 byte at 9600 baud, each data bit is a 0x00 or 0xFF byte at
+ 115200 baud (respectively 115200 and 1000000 baud at overdrive speed). The TX and RX pins are wired together
+ on the bus through an open drain driver (or a diode), so that every byte sent comes back on RX as seen on
+ the bus. The eight slots of a byte are queued at once in the serial buffers, which are served by the serial
+ interrupts: interrupts are never disabled by the 1-Wire code.
+ \remark Every 1-Wire byte is eight UART bytes, that is eight receive interrupts (and as many transmit ones)
+ instead of one: count them in the interrupt load of the application.
+ \remark The strong pullup is not available with this wiring: \c write() with \c power set sends the byte and
+ raises \c ERROR_NOT_SUPPORTED.
+ */
+
+class OWuart : public OWcomponent {
+private:
+	/**
+	 \var HardwareSerial *_serial
+	 \brief UART driving the bus.
+	 */
+	HardwareSerial *_serial;
+	/**
+	 \var unsigned long _resetBaud
+	 \brief Baud rate used for reset pulses.
+	 */
+	unsigned long _resetBaud;
+	/**
+	 \var unsigned long _dataBaud
+	 \brief Baud rate used for data slots.
+	 */
+	unsigned long _dataBaud;
+
+	/**
+	 \fn bool exchange(const uint8_t *tx, uint8_t *rx, uint8_t n)
+	 \brief Sends \c n slot bytes and collects their echoes.
+	 \return \c True if all the echoes have been received, \c False (and \c ERROR_TIME_OUT is raised) otherwise.
+	 */
+	bool exchange(const uint8_t *tx, uint8_t *rx, uint8_t n);
+
+protected:
+	uint8_t bus_reset(void);
+	void bus_write_bit(uint8_t v);
+	uint8_t bus_read_bit(void);
+	void bus_write(uint8_t v, uint8_t power);
+	uint8_t bus_read(void);
+	void bus_depower(void);
+	void bus_speed(uint8_t speed);
+
+public:
+	/**
+	 \fn OWuart(HardwareSerial &s)
+	 \brief Constructor
+	 @param s UART wired to the bus (\c Serial1, for example). It must not be used for anything else.
+	 */
+	OWuart(HardwareSerial &s);
+	/**
+	 \fn void begin(void)
+	 \brief Opens the UART at the data speed. Call it in \c setup(), the serial port cannot be started by a global
+	 constructor.
+	 */
+	void begin(void);
+
+	/**
+	 \fn static void encode(uint8_t v, uint8_t *slots)
+	 \brief Encodes a byte as the eight UART bytes generating its slots (LSB first).
+	 @param v Byte to encode.
+	 @param slots Buffer of 8 bytes receiving the slots.
+	 */
+	static void encode(uint8_t v, uint8_t *slots);
+	/**
+	 \fn static uint8_t decode(const uint8_t *slots)
+	 \brief Decodes the echoes of eight slots into the byte seen on the bus.
+	 @param slots Buffer of 8 echoes, LSB first.
+	 \return The byte seen on the bus: a bit is 1 if its slot came back unchanged.
+	 */
+	static uint8_t decode(const uint8_t *slots);
+	/**
+	 \fn static uint8_t presence(uint8_t echo)
+	 \brief Decodes the echo of a reset byte.
+	 \return \c 1 if a presence pulse has been detected, \c 0 if no device answered or the bus is shorted.
+	 */
+	static uint8_t presence(uint8_t echo);
+};
+
+#endif
@@ -52,7 +52,7 @@ protected:
 	virtual void read(void) = 0;  // read data from sensor
 	
 public:
-	inline Sensor(uint8_t id, uint8_t t) : Component(id,t) { }
+	inline Sensor(uint32_t id, uint32_t t) : Component(id,t) { }
 	/**
 	 \fn virtual void begin(void) = 0
 	 \brief Initializes the sensor.
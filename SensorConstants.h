@@ -54,6 +54,7 @@
 #define S_LM34  0x06884901
 #define S_LM35  0x446904b2
 #define S_DS18B20 0xfb04f450
+#define S_DS18S20 0x2e6b91c3
 #define S_GENERIC_PIR 0x1111
 
 //@}
@@ -0,0 +1,50 @@
+/**
+ * \file DS18B20fleet.ino
+ * \brief Monitors up to 32 DS18B20 sensors connected to pin 2 and prints
+ * the address and the temperature of the sensors out of the 18-28 Celsius
+ * degrees range.
+ * \author Enrico Formenti
+ * \version 0.1
+ * \date 2012-2013
+ * \warning The author is not responsible for any damage or... 
+ * caused by this software. Use it at your own risk.
+ * \copyright BSD license. See license.txt for more details. 
+ * All text above must be included in any redistribution. 
+ */
+
+#include <DS18B20fleet.h>
+
+#define MAX_SENSORS 32
+
+OWcomponent bus(2);
+uint8_t roms[MAX_SENSORS][8];
+DS18B20fleet fleet(bus, roms, MAX_SENSORS);
+
+void alarm(uint8_t index, uint8_t rom[8], int16_t raw)
+{
+  uint8_t i;
+
+  for(i=0;i<8;i++) {
+    Serial.print(rom[i], HEX);
+    Serial.print(" ");
+  }
+  Serial.print(": ");
+  Serial.println(raw / 16.0);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  Serial.print(fleet.discover());
+  Serial.println(" sensors found");
+  if (!fleet.setAlarms(18, 28))
+    Serial.println("cannot program the alarms");
+  fleet.onAlarm(alarm);
+}
+
+void loop(){
+
+  if (!fleet.poll())
+    Serial.println("all quiet");
+  delay(5000);
+}
@@ -0,0 +1,44 @@
+/**
+ * \file DS18B20group.ino
+ * \brief Reads up to 32 DS18B20 sensors connected to pin 2 in one
+ * conversion cycle and prints their temperatures.
+ * \author Enrico Formenti
+ * \version 0.1
+ * \date 2012-2013
+ * \warning The author is not responsible for any damage or... 
+ * caused by this software. Use it at your own risk.
+ * \copyright BSD license. See license.txt for more details. 
+ * All text above must be included in any redistribution. 
+ */
+
+#include <DS18B20group.h>
+
+#define MAX_SENSORS 32
+
+OWcomponent bus(2);
+uint8_t roms[MAX_SENSORS][8];
+DS18B20group group(bus, roms, MAX_SENSORS);
+int16_t raw[MAX_SENSORS];
+uint16_t status[MAX_SENSORS];
+
+void setup()
+{
+  Serial.begin(9600);
+  Serial.print(group.discover());
+  Serial.println(" sensors found");
+}
+
+void loop(){
+  uint8_t i;
+
+  group.readAll(raw, status);
+  for(i=0;i<group.getCount();i++) {
+    Serial.print(i);
+    Serial.print(": ");
+    if(status[i] == ERROR_NONE)
+      Serial.println(raw[i] / 16.0);
+    else
+      Serial.println("read error");
+  }
+  delay(5000);
+}
@@ -0,0 +1,49 @@
+/**
+ * \file DS2482scan.ino
+ * \brief Lists the devices found on each of the eight 1-Wire buses of a
+ * DS2482-800 bridge. The bridge is connected to the I2C pins of Arduino and
+ * has both AD0 and AD1 tied to ground.
+ * \author Enrico Formenti
+ * \version 0.1
+ * \date 2012-2013
+ * \warning The author is not responsible for any damage or... 
+ * caused by this software. Use it at your own risk.
+ * \copyright BSD license. See license.txt for more details. 
+ * All text above must be included in any redistribution. 
+ */
+
+#include <Wire.h>
+#include <DS2482.h>
+#include <Serial.h>
+
+DS2482 bridge(DS2482_ADDRESS);
+
+void setup()
+{
+  Serial.begin(9600);
+  if (!bridge.begin())
+    Serial.println("DS2482 not found");
+}
+
+void loop(){
+
+  uint8_t ROM[8], ch, i;
+
+  for(ch=0;ch<8;ch++) {
+    if (!bridge.selectChannel(ch))
+      continue;
+
+    Serial.print("Channel ");
+    Serial.println(ch);
+
+    while (bridge.search(ROM, CMD_GENERIC_SEARCH)) {
+      Serial.print(" ");
+      for(i=0;i<8;i++) {
+        Serial.print(ROM[i], HEX);
+        Serial.print(" ");
+      }
+      Serial.println();
+    }
+  }
+  delay(5000);
+}
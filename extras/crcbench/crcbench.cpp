@@ -0,0 +1,141 @@
+/**
+ * \file crcbench.cpp
+ * \brief Host benchmark of the CRC kernels of OWcrc.
+ * \details For each kernel, prints the flash taken by its tables and its
+ * speed in nanoseconds (and cycles, on x86) per byte, after checking that
+ * it computes the same CRC as the bitwise reference. Build and run it from
+ * this directory with:
+ * \code
+ *   g++ -std=gnu++11 -O2 -I../.. crcbench.cpp ../../OWcrc.cpp -o crcbench
+ *   ./crcbench
+ * \endcode
+ * Speeds are the host's, use them to rank the kernels, not as AVR figures.
+ * \author Enrico Formenti
+ * \version 0.1
+ * \date 2012-2013
+ * \warning The author is not responsible for any damage or...
+ * caused by this software. Use it at your own risk.
+ * \copyright BSD license. See license.txt for more details.
+ * All text above must be included in any redistribution.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#include "OWcrc.h"
+
+#define BUF_SIZE 4096
+#define ROUNDS 2000
+
+static uint8_t buf[BUF_SIZE];
+
+typedef uint8_t (*crc8_kernel)(uint8_t, uint8_t);
+typedef uint16_t (*crc16_kernel)(uint16_t, uint8_t);
+
+static uint16_t crc16_sliced(const uint8_t *b, uint32_t len, uint16_t crc)
+{
+	return OWcrc::crc16_slice4(b, len, crc);
+}
+
+static void report(const char *name, unsigned table_bytes, bool ok,
+                   std::chrono::steady_clock::duration d, unsigned long long cycles)
+{
+	double bytes = (double)BUF_SIZE * ROUNDS;
+	double ns = std::chrono::duration<double, std::nano>(d).count() / bytes;
+
+	printf("%-14s %6u %10.3f", name, table_bytes, ns);
+	if (cycles)
+		printf(" %12.3f", cycles / bytes);
+	else
+		printf(" %12s", "-");
+	printf("   %s\n", ok ? "ok" : "WRONG");
+}
+
+static void bench8(const char *name, crc8_kernel k, unsigned table_bytes, uint8_t ref)
+{
+	volatile uint8_t sink;
+	uint8_t crc = 0;
+	unsigned long long c0 = 0, c1 = 0;
+
+	for (uint32_t i = 0; i < BUF_SIZE; i++)
+		crc = k(crc, buf[i]);
+
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+#ifdef HAVE_RDTSC
+	c0 = __rdtsc();
+#endif
+	for (int r = 0; r < ROUNDS; r++) {
+		uint8_t c = 0;
+		for (uint32_t i = 0; i < BUF_SIZE; i++)
+			c = k(c, buf[i]);
+		sink = c;
+	}
+#ifdef HAVE_RDTSC
+	c1 = __rdtsc();
+#endif
+	report(name, table_bytes, crc == ref, std::chrono::steady_clock::now() - t0, c1 - c0);
+	(void)sink;
+}
+
+static void bench16(const char *name, crc16_kernel k, uint16_t (*bulk)(const uint8_t *, uint32_t, uint16_t),
+                    unsigned table_bytes, uint16_t ref)
+{
+	volatile uint16_t sink;
+	uint16_t crc = 0;
+	unsigned long long c0 = 0, c1 = 0;
+
+	if (bulk)
+		crc = bulk(buf, BUF_SIZE, 0);
+	else
+		for (uint32_t i = 0; i < BUF_SIZE; i++)
+			crc = k(crc, buf[i]);
+
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+#ifdef HAVE_RDTSC
+	c0 = __rdtsc();
+#endif
+	for (int r = 0; r < ROUNDS; r++) {
+		uint16_t c = 0;
+		if (bulk)
+			c = bulk(buf, BUF_SIZE, 0);
+		else
+			for (uint32_t i = 0; i < BUF_SIZE; i++)
+				c = k(c, buf[i]);
+		sink = c;
+	}
+#ifdef HAVE_RDTSC
+	c1 = __rdtsc();
+#endif
+	report(name, table_bytes, crc == ref, std::chrono::steady_clock::now() - t0, c1 - c0);
+	(void)sink;
+}
+
+int main(void)
+{
+	uint8_t ref8 = 0;
+	uint16_t ref16 = 0;
+
+	srand(1);
+	for (uint32_t i = 0; i < BUF_SIZE; i++) {
+		buf[i] = rand();
+		ref8 = OWcrc::crc8_bitwise(ref8, buf[i]);
+		ref16 = OWcrc::crc16_bitwise(ref16, buf[i]);
+	}
+
+	printf("%-14s %6s %10s %12s\n", "kernel", "table", "ns/byte", "cycles/byte");
+	bench8("crc8 bitwise", OWcrc::crc8_bitwise, 0, ref8);
+	bench8("crc8 nibble", OWcrc::crc8_nibble, 32, ref8);
+	bench8("crc8 table", OWcrc::crc8_table, 256, ref8);
+	bench16("crc16 bitwise", OWcrc::crc16_bitwise, NULL, 0, ref16);
+	bench16("crc16 parity", OWcrc::crc16_parity, NULL, 16, ref16);
+	bench16("crc16 nibble", OWcrc::crc16_nibble, NULL, 64, ref16);
+	bench16("crc16 table", OWcrc::crc16_table, NULL, 512, ref16);
+	bench16("crc16 slice4", NULL, crc16_sliced, 2048, ref16);
+
+	return 0;
+}
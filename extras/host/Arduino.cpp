@@ -0,0 +1,115 @@
+/**
+ \file Arduino.cpp
+ \brief Host stand-in for the Arduino core.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "Arduino.h"
+
+static volatile uint8_t ports[HOST_PORTS][3];
+static unsigned long now_us = 0;
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	volatile uint8_t *reg = portInputRegister(digitalPinToPort(pin));
+
+	if (mode == OUTPUT)
+		reg[1] |= digitalPinToBitMask(pin);
+	else
+		reg[1] &= ~digitalPinToBitMask(pin);
+}
+
+uint8_t digitalPinToPort(uint8_t pin) {
+	return (pin >> 3) % HOST_PORTS;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin) {
+	return 1 << (pin & 7);
+}
+
+volatile uint8_t *portInputRegister(uint8_t port) {
+	return ports[port % HOST_PORTS];
+}
+
+void hostAdvance(unsigned long us) {
+	now_us += us;
+}
+
+void delayMicroseconds(unsigned int us) {
+	hostAdvance(us);
+}
+
+void delay(unsigned long ms) {
+	hostAdvance(ms * 1000);
+}
+
+unsigned long micros(void) {
+	return now_us;
+}
+
+unsigned long millis(void) {
+	// polling loops on millis() must end: reading it takes a microsecond
+	now_us++;
+	return now_us / 1000;
+}
+
+HardwareSerial::HardwareSerial(void) {
+	_baud = 9600;
+	_wire = NULL;
+	_head = _tail = 0;
+}
+
+void HardwareSerial::attach(HostSerialWire w) {
+	_wire = w;
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+	_baud = baud;
+	_head = _tail = 0;
+}
+
+void HardwareSerial::end(void) {
+	_head = _tail = 0;
+}
+
+int HardwareSerial::available(void) {
+	return (uint8_t)(_head - _tail) % sizeof(_rx);
+}
+
+int HardwareSerial::read(void) {
+	if (_head == _tail)
+		return -1;
+	uint8_t b = _rx[_tail];
+	_tail = (_tail + 1) % sizeof(_rx);
+	return b;
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+	unsigned long start = micros(), frame = 10000000UL / _baud;  // start bit, 8 data bits, stop bit
+
+	// the wire may simulate the frame itself and move the clock
+	_rx[_head] = _wire ? _wire(_baud, b) : b;
+	if (micros() - start < frame)
+		hostAdvance(frame - (micros() - start));
+	_head = (_head + 1) % sizeof(_rx);
+	return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t n) {
+	for (size_t i = 0; i < n; i++)
+		write(buf[i]);
+	return n;
+}
+
+void HardwareSerial::flush(void) {
+	// bytes are sent synchronously
+}
@@ -0,0 +1,110 @@
+/**
+ \file Arduino.h
+ \brief Host stand-in for the Arduino core.
+ \details Just enough of the Arduino core to build the library on a host (Linux, macOS): integer types,
+ pin and port lookup, a simulated clock driven by \c delay() and \c delayMicroseconds(), and a mock
+ \c HardwareSerial. Put this directory first in the include path and define \c ARDUINO=100.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x0
+#define OUTPUT 0x1
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define memcpy_P memcpy
+
+#define noInterrupts()
+#define interrupts()
+
+/**
+ \name Pins and ports
+ \brief Pin \c p is bit \c p%8 of port \c p/8. Each port has the AVR layout: input, direction and output
+ registers in a row.
+ */
+//@{
+#define HOST_PORTS 4
+void pinMode(uint8_t pin, uint8_t mode);
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t *portInputRegister(uint8_t port);
+//@}
+
+/**
+ \name Simulated clock
+ \brief Time only goes forward when the code waits, and by one microsecond at each call to \c millis() so that
+ polling loops end.
+ */
+//@{
+void delayMicroseconds(unsigned int us);
+void delay(unsigned long ms);
+unsigned long micros(void);
+unsigned long millis(void);
+/**
+ \fn void hostAdvance(unsigned long us)
+ \brief Moves the simulated clock forward by \c us microseconds.
+ */
+void hostAdvance(unsigned long us);
+//@}
+
+/**
+ \typedef uint8_t (*HostSerialWire)(unsigned long baud, uint8_t tx)
+ \brief What is wired to the TX/RX pins of a mock serial port: gets each byte sent and returns what comes
+ back on RX.
+ */
+typedef uint8_t (*HostSerialWire)(unsigned long baud, uint8_t tx);
+
+/**
+ \class HardwareSerial Arduino.h
+ \brief Mock serial port with TX looped back to RX through a \c HostSerialWire.
+
+ Each byte sent takes 10 bit times of simulated clock. Without a wire attached, bytes come back unchanged.
+ */
+class HardwareSerial {
+private:
+	unsigned long _baud;
+	HostSerialWire _wire;
+	uint8_t _rx[64];
+	uint8_t _head, _tail;
+
+public:
+	HardwareSerial(void);
+	void attach(HostSerialWire w);
+	void begin(unsigned long baud);
+	void end(void);
+	int available(void);
+	int read(void);
+	size_t write(uint8_t b);
+	size_t write(const uint8_t *buf, size_t n);
+	void flush(void);
+	unsigned long baud(void) { return _baud; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif
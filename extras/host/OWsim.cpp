@@ -0,0 +1,635 @@
+/**
+ \file OWsim.cpp
+ \brief Implementation of the 1-Wire simulator.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "OWsim.h"
+#include "OWcrc.h"
+
+// Device states
+#define S_IDLE   0  // waiting for a reset
+#define S_ROM    1  // waiting for a ROM command
+#define S_MATCH  2  // receiving the ROM of a MATCH ROM
+#define S_SEARCH 3  // search algorithm
+#define S_FUNC   4  // selected, waiting for a function command
+#define S_DATA   5  // receiving data bytes
+#define S_STATUS 6  // answering read slots with status()
+
+// Slot decoding (microseconds): a device sees a reset if the line is held low for
+// at least RESET_MIN, a slot if it is held low for at most SLOT_MAX. It samples the
+// line SAMPLE after the falling edge.
+#define STD_RESET_MIN 400
+#define STD_SLOT_MAX 120
+#define STD_SAMPLE 30
+#define STD_PRESENCE_WAIT 30
+#define STD_PRESENCE_LOW 120
+#define OD_RESET_MIN 48
+#define OD_SLOT_MAX 16
+#define OD_SAMPLE 3
+#define OD_PRESENCE_WAIT 3
+#define OD_PRESENCE_LOW 10
+// shortest time slot, recovery included
+#define STD_SLOT_MIN 61
+#define OD_SLOT_MIN 7
+
+// Status answered by the DS18B20
+#define STATUS_BUSY 0
+#define STATUS_POWER 1
+
+static OWsimWire *wires[OWSIM_MAX_WIRES];
+static uint8_t nwires = 0;
+
+OWsimWire *OWsimWire::serialWire = NULL;
+
+//
+// Register access from the DIRECT_XXX macros
+//
+uint8_t owsim_read(volatile uint8_t *base, uint8_t mask) {
+	uint8_t r = 0, bit;
+	OWsimWire *w;
+
+	for (bit = 0; bit < 8; bit++) {
+		if (!(mask & (1 << bit)))
+			continue;
+		w = OWsimWire::find(base, bit);
+		if (!w || w->sense())
+			r |= (1 << bit);
+	}
+	return r;
+}
+
+void owsim_write(volatile uint8_t *base, uint8_t reg, uint8_t mask, uint8_t v) {
+	uint8_t bit, dir, out;
+	OWsimWire *w;
+
+	if (v)
+		base[reg] |= mask;
+	else
+		base[reg] &= ~mask;
+
+	for (bit = 0; bit < 8; bit++) {
+		if (!(mask & (1 << bit)))
+			continue;
+		w = OWsimWire::find(base, bit);
+		if (!w)
+			continue;
+		dir = base[1] & (1 << bit);
+		out = base[2] & (1 << bit);
+		w->drive(dir && !out, dir && out);
+	}
+}
+
+static void advanceTo(unsigned long t) {
+	if ((long)(t - micros()) > 0)
+		hostAdvance(t - micros());
+}
+
+//
+// UART frame on an open drain wire: 0 bits pull the line low, 1 bits
+// release it. RX samples the line in the middle of each bit.
+//
+uint8_t owsim_serial(unsigned long baud, uint8_t tx) {
+	OWsimWire *w = OWsimWire::serialWire;
+	unsigned long start = micros();
+	uint16_t frame = (0x200 | (tx << 1));  // start bit, data LSB first, stop bit
+	uint8_t i, rx = 0;
+
+	if (!w)
+		return tx;
+
+	for (i = 0; i < 10; i++) {
+		advanceTo(start + (i * 1000000UL) / baud);
+		w->drive(!((frame >> i) & 1), false);
+		advanceTo(start + ((2 * i + 1) * 500000UL) / baud);
+		if (i >= 1 && i <= 8 && w->sense())
+			rx |= (1 << (i - 1));
+	}
+	advanceTo(start + 10000000UL / baud);
+	return rx;
+}
+
+//
+// Wires
+//
+OWsimWire::OWsimWire(void) {
+	_base = NULL;
+	_mask = 0;
+	_n = 0;
+	_low = _strong = _short = false;
+	_rise = 0;
+	_fall = _release = 0;
+	_violations = 0;
+}
+
+OWsimWire::~OWsimWire() {
+	uint8_t i;
+
+	for (i = 0; i < nwires && wires[i] != this; i++) ;
+	if (i < nwires) {
+		memmove(&wires[i], &wires[i + 1], (nwires - i - 1) * sizeof(OWsimWire *));
+		nwires--;
+	}
+	if (serialWire == this)
+		serialWire = NULL;
+}
+
+void OWsimWire::attach(uint8_t pin) {
+	_base = portInputRegister(digitalPinToPort(pin));
+	_mask = digitalPinToBitMask(pin);
+	if (nwires < OWSIM_MAX_WIRES)
+		wires[nwires++] = this;
+}
+
+void OWsimWire::attach(HardwareSerial &s) {
+	serialWire = this;
+	s.attach(owsim_serial);
+}
+
+OWsimWire *OWsimWire::find(volatile uint8_t *base, uint8_t bit) {
+	for (uint8_t i = 0; i < nwires; i++)
+		if (wires[i]->_base == base && wires[i]->_mask == (1 << bit))
+			return wires[i];
+	return NULL;
+}
+
+bool OWsimWire::add(OWsimDevice &d) {
+	if (_n == OWSIM_MAX_DEVICES)
+		return false;
+	_dev[_n++] = &d;
+	d._wire = this;
+	return true;
+}
+
+bool OWsimWire::lowAt(unsigned long t) {
+	// the master pulled the line from _fall to _release (or still does)
+	if (_short || _low || t - _fall < (_release - _fall) + _rise)
+		return true;
+	for (uint8_t i = 0; i < _n; i++)
+		if (_dev[i]->pulling(t, _rise))
+			return true;
+	return false;
+}
+
+uint8_t OWsimWire::sense(void) {
+	return lowAt(micros()) ? 0 : 1;
+}
+
+void OWsimWire::drive(bool low, bool strong) {
+	unsigned long now = micros();
+	uint8_t i;
+
+	if (low && !_low) {
+		// falling edge: devices having a 0 to send start pulling now
+		_low = true;
+		_fall = now;
+		for (i = 0; i < _n; i++)
+			_dev[i]->slotStart(now);
+	}
+	else if (!low && _low) {
+		_low = false;
+		_release = now;
+		release(now);
+	}
+	_strong = strong && !low;
+	for (i = 0; i < _n; i++)
+		if (_dev[i]->_connected)
+			_dev[i]->power(_strong);
+}
+
+//
+// The master released the line: each device decodes what it saw
+// according to its own speed
+//
+void OWsimWire::release(unsigned long t) {
+	unsigned long dur = t - _fall;
+	OWsimDevice *d;
+
+	for (uint8_t i = 0; i < _n; i++) {
+		d = _dev[i];
+		if (!d->_connected)
+			continue;
+		if (dur >= (d->_od ? OD_RESET_MIN : STD_RESET_MIN))
+			d->busReset(t, dur < STD_RESET_MIN);
+		else if (dur <= (d->_od ? OD_SLOT_MAX : STD_SLOT_MAX))
+			d->slotEnd(lowAt(_fall + (d->_od ? OD_SAMPLE : STD_SAMPLE)) ? 0 : 1);
+	}
+}
+
+//
+// Devices
+//
+OWsimDevice::OWsimDevice(uint8_t family, uint32_t serial) {
+	uint8_t i;
+
+	_rom[0] = family;
+	for (i = 1; i < 7; i++, serial >>= 8)
+		_rom[i] = serial & 0xFF;
+	_rom[7] = 0;
+	for (i = 0; i < 7; i++)
+		_rom[7] = OWcrc::crc8_bitwise(_rom[7], _rom[i]);
+
+	_connected = true;
+	_parasite = false;
+	_odCapable = false;
+	_hold = 30;
+	_flipRate = _flipCount = 0;
+	_wire = NULL;
+	_pullFrom = _pullTo = 0;
+	_inSlot = _missed = false;
+	OWsimDevice::powerCycle();
+}
+
+void OWsimDevice::powerCycle(void) {
+	_state = S_IDLE;
+	_od = false;
+	_resume = false;
+	_txLen = _txBit = 0;
+	_rx = _rxBits = 0;
+	_sending = false;
+}
+
+void OWsimDevice::connect(bool c) {
+	_connected = c;
+	// a device plugged in waits for the next reset
+	_state = S_IDLE;
+	_pullFrom = _pullTo = 0;
+}
+
+bool OWsimDevice::pulling(unsigned long t, uint8_t rise) {
+	return _connected && t - _pullFrom < (_pullTo - _pullFrom) + rise;
+}
+
+void OWsimDevice::busReset(unsigned long t, bool od) {
+	// a standard speed reset brings overdrive devices back to standard speed
+	if (!od)
+		_od = false;
+	_state = S_ROM;
+	_rx = _rxBits = 0;
+	_txLen = _txBit = 0;
+	_inSlot = _missed = false;
+	// presence pulse
+	_pullFrom = t + (_od ? OD_PRESENCE_WAIT : STD_PRESENCE_WAIT);
+	_pullTo = _pullFrom + (_od ? OD_PRESENCE_LOW : STD_PRESENCE_LOW);
+}
+
+void OWsimDevice::slotStart(unsigned long t) {
+	int8_t bit = -1;
+
+	_sending = false;
+	if (!_connected || _state == S_IDLE)
+		return;
+
+	// still in the previous slot: this falling edge goes unnoticed
+	_missed = _inSlot && t - _slotFrom < (_od ? OD_SLOT_MIN : STD_SLOT_MIN);
+	if (_missed) {
+		_wire->_violations++;
+		return;
+	}
+	_inSlot = true;
+	_slotFrom = t;
+
+	if (_state == S_SEARCH) {
+		if (_searchPhase < 2) {
+			bit = (_rom[_searchBit >> 3] >> (_searchBit & 7)) & 1;
+			if (_searchPhase == 1)
+				bit ^= 1;
+			_searchPhase++;
+		}
+	}
+	else if (_txBit < _txLen * 8) {
+		bit = (_tx[_txBit >> 3] >> (_txBit & 7)) & 1;
+		_txBit++;
+	}
+	else if (_state == S_STATUS)
+		bit = status();
+
+	if (bit < 0)
+		return;
+	_sending = true;
+	if (_flipRate && ++_flipCount >= _flipRate) {
+		_flipCount = 0;
+		bit ^= 1;
+	}
+	if (!bit) {
+		_pullFrom = t;
+		_pullTo = t + (_od ? _hold / 8 + 1 : _hold);
+	}
+}
+
+void OWsimDevice::slotEnd(uint8_t bit) {
+	uint8_t b;
+
+	// a device sending in this slot does not listen
+	if (_missed || _sending || _state == S_IDLE || _state == S_STATUS)
+		return;
+
+	if (_state == S_SEARCH) {
+		if (bit != ((_rom[_searchBit >> 3] >> (_searchBit & 7)) & 1)) {
+			_state = S_IDLE;  // the master went the other way
+			return;
+		}
+		_searchPhase = 0;
+		if (++_searchBit == 64) {
+			_state = S_FUNC;
+			_resume = true;
+		}
+		return;
+	}
+
+	_rx = (_rx >> 1) | (bit ? 0x80 : 0);
+	if (++_rxBits < 8)
+		return;
+	b = _rx;
+	_rxBits = 0;
+
+	switch (_state) {
+	case S_ROM:
+		romCommand(b);
+		break;
+	case S_MATCH:
+		if (b != _rom[_rxCount])
+			_state = S_IDLE;
+		else if (++_rxCount == 8) {
+			_state = S_FUNC;
+			_resume = true;
+		}
+		break;
+	case S_FUNC:
+		function(b);
+		break;
+	case S_DATA:
+		data(_rxCount, b);
+		if (++_rxCount == _rxWanted)
+			_state = S_IDLE;
+		break;
+	}
+}
+
+void OWsimDevice::romCommand(uint8_t cmd) {
+	// any ROM command but RESUME clears the RESUME flag
+	if (cmd != 0xA5)
+		_resume = false;
+
+	switch (cmd) {
+	case 0x33:  // READ ROM
+		send(_rom, 8);
+		_state = S_FUNC;
+		_resume = true;
+		break;
+	case 0x69:  // OVERDRIVE MATCH
+		if (!_odCapable) {
+			_state = S_IDLE;
+			break;
+		}
+		_od = true;
+		// fall through
+	case 0x55:  // MATCH ROM
+		_state = S_MATCH;
+		_rxCount = 0;
+		break;
+	case 0x3C:  // OVERDRIVE SKIP
+		if (!_odCapable) {
+			_state = S_IDLE;
+			break;
+		}
+		_od = true;
+		// fall through
+	case 0xCC:  // SKIP ROM
+		_state = S_FUNC;
+		break;
+	case 0xEC:  // ALARM SEARCH
+		if (!alarm()) {
+			_state = S_IDLE;
+			break;
+		}
+		// fall through
+	case 0xF0:  // SEARCH ROM
+		_state = S_SEARCH;
+		_searchBit = 0;
+		_searchPhase = 0;
+		break;
+	case 0xA5:  // RESUME
+		_state = _resume ? S_FUNC : S_IDLE;
+		break;
+	default:
+		_state = S_IDLE;
+	}
+}
+
+void OWsimDevice::send(const uint8_t *buf, uint8_t n) {
+	if (n > sizeof(_tx))
+		n = sizeof(_tx);
+	memcpy(_tx, buf, n);
+	_txLen = n;
+	_txBit = 0;
+}
+
+void OWsimDevice::receive(uint8_t n) {
+	_state = S_DATA;
+	_rxWanted = n;
+	_rxCount = 0;
+}
+
+void OWsimDevice::answerStatus(void) {
+	_state = S_STATUS;
+}
+
+//
+// DS18B20 / DS18S20
+//
+OWsimDS18B20::OWsimDS18B20(uint32_t serial, bool s20) : OWsimDevice(s20 ? 0x10 : 0x28, serial) {
+	_temp = 25 * 16;
+	_eeprom[0] = 0x4B;  // TH = 75
+	_eeprom[1] = 0x46;  // TL = 70
+	_eeprom[2] = 0x7F;  // 12 bits
+	_stuck = false;
+	powerCycle();
+}
+
+bool OWsimDS18B20::isS20(void) {
+	return getRom()[0] == 0x10;
+}
+
+void OWsimDS18B20::powerCycle(void) {
+	OWsimDevice::powerCycle();
+	// power-on value of the temperature register is 85 Celsius degrees
+	if (isS20()) {
+		_sp[0] = 0xAA;
+		_sp[1] = 0x00;
+		_sp[4] = 0xFF;
+	}
+	else {
+		_sp[0] = 0x50;
+		_sp[1] = 0x05;
+		_sp[4] = _eeprom[2];
+	}
+	_sp[2] = _eeprom[0];
+	_sp[3] = _eeprom[1];
+	_sp[5] = 0xFF;
+	_sp[6] = 0x0C;
+	_sp[7] = 0x10;
+	setCrc();
+	_busy = false;
+	_converting = false;
+	_alarm = false;
+	_unpowered = true;
+	_unpoweredAt = 0;
+	_statusKind = STATUS_BUSY;
+}
+
+uint16_t OWsimDS18B20::conversionTime(void) {
+	if (isS20())
+		return 750;
+	// 750 ms at 12 bits, halved for each bit less (rounded up)
+	return (750 + (8 >> ((_sp[4] >> 5) & 0x03)) - 1) >> (3 - ((_sp[4] >> 5) & 0x03));
+}
+
+void OWsimDS18B20::setCrc(void) {
+	_sp[8] = 0;
+	for (uint8_t i = 0; i < 8; i++)
+		_sp[8] = OWcrc::crc8_bitwise(_sp[8], _sp[i]);
+}
+
+void OWsimDS18B20::update(void) {
+	unsigned long end;
+
+	if (!_busy)
+		return;
+	// a parasite powered device runs out of power without the strong pullup
+	end = ((long)(micros() - _busyEnd) < 0) ? micros() : _busyEnd;
+	if (isParasite() && _unpowered && (long)(end - _unpoweredAt) > OWSIM_HOLDUP) {
+		brownOut();
+		return;
+	}
+	if ((long)(micros() - _busyEnd) < 0 || (_converting && _stuck))
+		return;
+	_busy = false;
+	if (_converting)
+		finishConversion();
+	else {
+		// end of a copy scratchpad
+		_eeprom[0] = _sp[2];
+		_eeprom[1] = _sp[3];
+		if (!isS20())
+			_eeprom[2] = _sp[4];
+	}
+	_converting = false;
+}
+
+void OWsimDS18B20::finishConversion(void) {
+	int16_t raw, reg;
+	int8_t t;
+
+	if (isS20()) {
+		// 0.5 degree register, plus the counters of the extended resolution:
+		// T = reg/2 (truncated) - 0.25 + (16 - COUNT_REMAIN)/16
+		raw = _temp >> 4;
+		if ((_temp & 15) <= 12) {
+			reg = raw * 2 + ((_temp & 15) >= 8 ? 1 : 0);
+			_sp[6] = 12 - (_temp & 15);
+		}
+		else {
+			reg = (raw + 1) * 2;
+			_sp[6] = 28 - (_temp & 15);
+		}
+		_sp[7] = 16;
+		t = reg >> 1;
+	}
+	else {
+		// the bits below the resolution are undefined, clear them
+		reg = _temp & ~((1 << (3 - ((_sp[4] >> 5) & 0x03))) - 1);
+		t = reg >> 4;
+	}
+	_sp[0] = reg & 0xFF;
+	_sp[1] = (reg >> 8) & 0xFF;
+	setCrc();
+	_alarm = (t <= (int8_t)_sp[3] || t >= (int8_t)_sp[2]);
+}
+
+void OWsimDS18B20::function(uint8_t cmd) {
+	update();
+	switch (cmd) {
+	case 0x44:  // CONVERT T
+		_busy = _converting = true;
+		_busyEnd = micros() + conversionTime() * 1000UL;
+		_unpoweredAt = micros();
+		_statusKind = STATUS_BUSY;
+		answerStatus();
+		break;
+	case 0xBE:  // READ SCRATCHPAD
+		send(_sp, 9);
+		break;
+	case 0x4E:  // WRITE SCRATCHPAD
+		receive(isS20() ? 2 : 3);
+		break;
+	case 0x48:  // COPY SCRATCHPAD
+		_busy = true;
+		_converting = false;
+		_busyEnd = micros() + 10000UL;
+		_unpoweredAt = micros();
+		_statusKind = STATUS_BUSY;
+		answerStatus();
+		break;
+	case 0xB8:  // RECALL E2
+		_sp[2] = _eeprom[0];
+		_sp[3] = _eeprom[1];
+		if (!isS20())
+			_sp[4] = _eeprom[2];
+		setCrc();
+		_statusKind = STATUS_BUSY;
+		answerStatus();
+		break;
+	case 0xB4:  // READ POWER SUPPLY
+		_statusKind = STATUS_POWER;
+		answerStatus();
+		break;
+	}
+}
+
+void OWsimDS18B20::data(uint8_t i, uint8_t b) {
+	if (i == 2)
+		b = (b & 0x60) | 0x1F;  // only R1 and R0 can be written
+	_sp[2 + i] = b;
+	setCrc();
+}
+
+uint8_t OWsimDS18B20::status(void) {
+	update();
+	if (_statusKind == STATUS_POWER)
+		return isParasite() ? 0 : 1;
+	return _busy ? 0 : 1;
+}
+
+bool OWsimDS18B20::alarm(void) {
+	update();
+	return _alarm;
+}
+
+void OWsimDS18B20::power(bool strong) {
+	update();
+	if (strong)
+		_unpowered = false;
+	else if (!_unpowered) {
+		_unpowered = true;
+		_unpoweredAt = micros();
+	}
+}
+
+void OWsimDS18B20::brownOut(void) {
+	_busy = false;
+	if (_converting) {
+		// the temperature register is back to its power-on value
+		_sp[0] = isS20() ? 0xAA : 0x50;
+		_sp[1] = isS20() ? 0x00 : 0x05;
+		setCrc();
+	}
+	_converting = false;
+}
@@ -0,0 +1,357 @@
+/**
+ \file OWsim.h
+ \brief Slot level simulator of 1-Wire buses and devices, for running the library on a host.
+ \details When the library is compiled with \c ONEWIRE_SIM defined, the \c DIRECT_XXX macros of OWcomponent.h
+ call this simulator instead of touching the port registers. Each \c OWsimWire is attached to a pin (or to a mock
+ serial port, for \c OWuart) and carries a set of virtual devices. The simulator follows the line as driven by the
+ master and by the devices, using the simulated clock of the host Arduino core: slots are decoded from their
+ timings, exactly as a real device does, so that the timing bugs show up too.
+
+ Faults can be injected on a wire (short circuit, slow rising edges) or on a device (disconnection, bits flipped,
+ short hold time, power cycle). Parasite powered devices lose their conversion if the strong pullup is not held
+ for the whole conversion time.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef OWSIM_H
+#define OWSIM_H
+
+#include "Arduino.h"
+
+/**
+ \def OWSIM_MAX_WIRES 8
+ \brief Maximal number of simulated wires.
+ */
+#define OWSIM_MAX_WIRES 8
+/**
+ \def OWSIM_HOLDUP 10
+ \brief Time (in microseconds) a parasite powered device can run without the strong pullup while it is busy. The
+ datasheets ask for the strong pullup within 10 microseconds of the command.
+ */
+#define OWSIM_HOLDUP 10
+/**
+ \def OWSIM_MAX_DEVICES 32
+ \brief Maximal number of devices on a simulated wire.
+ */
+#define OWSIM_MAX_DEVICES 32
+
+/**
+ \name Register access
+ \brief Functions called by the \c DIRECT_XXX macros when \c ONEWIRE_SIM is defined.
+ */
+//@{
+/**
+ \fn uint8_t owsim_read(volatile uint8_t *base, uint8_t mask)
+ \brief Returns the level of the lines of port \c base selected by \c mask (bits of pins without a wire read as 1).
+ */
+uint8_t owsim_read(volatile uint8_t *base, uint8_t mask);
+/**
+ \fn void owsim_write(volatile uint8_t *base, uint8_t reg, uint8_t mask, uint8_t v)
+ \brief Sets (\c v = 1) or clears the bits \c mask of register \c reg (1 direction, 2 output) of port \c base.
+ */
+void owsim_write(volatile uint8_t *base, uint8_t reg, uint8_t mask, uint8_t v);
+/**
+ \fn uint8_t owsim_serial(unsigned long baud, uint8_t tx)
+ \brief \c HostSerialWire connecting a mock serial port to a simulated wire, see \c OWsimWire::attach().
+ */
+uint8_t owsim_serial(unsigned long baud, uint8_t tx);
+//@}
+
+class OWsimWire;
+
+/**
+ \class OWsimDevice OWsim.h
+ \brief Virtual 1-Wire device: reset and presence, ROM commands (READ, MATCH, SKIP, SEARCH, ALARM SEARCH, RESUME,
+ OVERDRIVE SKIP and MATCH). Derived classes implement the function commands.
+ */
+class OWsimDevice {
+	friend class OWsimWire;
+
+private:
+	uint8_t _rom[8];
+	bool _connected, _parasite, _odCapable;
+	uint8_t _hold;
+	uint16_t _flipRate, _flipCount;
+
+	// protocol state
+	uint8_t _state;
+	bool _od, _resume;
+	uint8_t _rx, _rxBits, _rxCount, _rxWanted;
+	uint8_t _tx[16];
+	uint8_t _txLen, _txBit;
+	uint8_t _searchBit, _searchPhase;
+	bool _sending;
+	// start of the current time slot, a falling edge before its end is missed
+	unsigned long _slotFrom;
+	bool _inSlot, _missed;
+
+	// time window during which the device pulls the line low
+	unsigned long _pullFrom, _pullTo;
+
+	void busReset(unsigned long t, bool od);
+	void slotStart(unsigned long t);
+	void slotEnd(uint8_t bit);
+	void romCommand(uint8_t cmd);
+	bool pulling(unsigned long t, uint8_t rise);
+
+protected:
+	/**
+	 \var OWsimWire *_wire
+	 \brief Wire the device is on.
+	 */
+	OWsimWire *_wire;
+
+	/**
+	 \fn virtual void function(uint8_t cmd)
+	 \brief Called when the device is selected and receives a function command.
+	 */
+	virtual void function(uint8_t cmd) = 0;
+	/**
+	 \fn virtual void data(uint8_t i, uint8_t b)
+	 \brief Called for each byte \c b received after \c receive() (\c i is its rank).
+	 */
+	virtual void data(uint8_t /* i */, uint8_t /* b */) { }
+	/**
+	 \fn virtual uint8_t status(void)
+	 \brief Returns the answer to a read slot after \c answerStatus().
+	 */
+	virtual uint8_t status(void) { return 1; }
+	/**
+	 \fn virtual bool alarm(void)
+	 \brief Returns \c True if the device answers an alarm search.
+	 */
+	virtual bool alarm(void) { return false; }
+	/**
+	 \fn virtual void power(bool strong)
+	 \brief Called each time the master changes the drive of the line, \c strong is \c True if it is actively held high.
+	 */
+	virtual void power(bool /* strong */) { }
+
+	/**
+	 \fn void send(const uint8_t *buf, uint8_t n)
+	 \brief Queues \c n bytes to be sent in the next read slots.
+	 */
+	void send(const uint8_t *buf, uint8_t n);
+	/**
+	 \fn void receive(uint8_t n)
+	 \brief Expects \c n data bytes, passed to \c data().
+	 */
+	void receive(uint8_t n);
+	/**
+	 \fn void answerStatus(void)
+	 \brief Answers all the following read slots with \c status(), until the next reset.
+	 */
+	void answerStatus(void);
+
+public:
+	/**
+	 \fn OWsimDevice(uint8_t family, uint32_t serial)
+	 \brief Constructor
+	 @param family Family code.
+	 @param serial Serial number (the upper 16 bits of the 48 bits serial number are 0). The CRC is computed.
+	 */
+	OWsimDevice(uint8_t family, uint32_t serial);
+	virtual ~OWsimDevice() { }
+
+	/**
+	 \fn uint8_t *getRom(void)
+	 \brief Returns the address of the device.
+	 */
+	inline uint8_t *getRom(void) { return _rom; }
+	/**
+	 \fn void connect(bool c)
+	 \brief Plugs (\c c = \c True) or unplugs the device.
+	 */
+	void connect(bool c);
+	/**
+	 \fn void setParasite(bool p)
+	 \brief Makes the device parasite powered.
+	 */
+	inline void setParasite(bool p) { _parasite = p; }
+	inline bool isParasite(void) { return _parasite; }
+	/**
+	 \fn void setOverdrive(bool od)
+	 \brief Makes the device support overdrive speed.
+	 */
+	inline void setOverdrive(bool od) { _odCapable = od; }
+	/**
+	 \fn void setHoldTime(uint8_t us)
+	 \brief Sets how long (in microseconds, standard speed) the device holds the line low to send a 0. Default is 30.
+	 */
+	inline void setHoldTime(uint8_t us) { _hold = us; }
+	/**
+	 \fn void setFlipRate(uint16_t n)
+	 \brief Fault injection: one bit out of \c n sent by the device is inverted (\c 0 for none).
+	 */
+	inline void setFlipRate(uint16_t n) { _flipRate = n; _flipCount = 0; }
+	/**
+	 \fn virtual void powerCycle(void)
+	 \brief Fault injection: the device loses its power and restarts with its power-on values.
+	 */
+	virtual void powerCycle(void);
+};
+
+/**
+ \class OWsimWire OWsim.h
+ \brief Simulated 1-Wire bus.
+ */
+class OWsimWire {
+	friend class OWsimDevice;
+
+private:
+	volatile uint8_t *_base;
+	uint8_t _mask;
+	OWsimDevice *_dev[OWSIM_MAX_DEVICES];
+	uint8_t _n;
+	bool _low, _strong, _short;
+	uint8_t _rise;
+	unsigned long _fall, _release;
+	unsigned long _violations;
+
+	void release(unsigned long t);
+	bool lowAt(unsigned long t);
+
+public:
+	OWsimWire(void);
+	~OWsimWire();
+
+	/**
+	 \fn void attach(uint8_t pin)
+	 \brief Connects the wire to pin \c pin of the host Arduino core.
+	 */
+	void attach(uint8_t pin);
+	/**
+	 \fn void attach(HardwareSerial &s)
+	 \brief Connects the wire to the TX and RX pins of mock serial port \c s (for \c OWuart). Only one wire can be
+	 connected to a serial port.
+	 */
+	void attach(HardwareSerial &s);
+	/**
+	 \fn bool add(OWsimDevice &d)
+	 \brief Puts device \c d on the wire.
+	 */
+	bool add(OWsimDevice &d);
+
+	/**
+	 \fn void setShort(bool s)
+	 \brief Fault injection: the line is held low (\c s = \c True) or released.
+	 */
+	inline void setShort(bool s) { _short = s; }
+	/**
+	 \fn void setRiseTime(uint8_t us)
+	 \brief Fault injection: time (in microseconds) for the line to go back high once released (cable capacitance).
+	 */
+	inline void setRiseTime(uint8_t us) { _rise = us; }
+	/**
+	 \fn unsigned long getViolations(void)
+	 \brief Returns the number of time slots started by the master before the devices were done with the previous
+	 one (tSLOT + tREC). The devices miss these slots, which corrupts the transfer.
+	 */
+	inline unsigned long getViolations(void) { return _violations; }
+	/**
+	 \fn void clearViolations(void)
+	 \brief Sets the number of timing violations back to 0.
+	 */
+	inline void clearViolations(void) { _violations = 0; }
+
+	/**
+	 \fn void drive(bool low, bool strong)
+	 \brief The master pulls the line low, drives it high (\c strong) or releases it.
+	 */
+	void drive(bool low, bool strong);
+	/**
+	 \fn uint8_t sense(void)
+	 \brief Returns the level of the line now.
+	 */
+	uint8_t sense(void);
+	/**
+	 \fn bool isStrong(void)
+	 \brief Returns \c True if the master actively drives the line high.
+	 */
+	inline bool isStrong(void) { return _strong; }
+
+	/**
+	 \fn static OWsimWire *find(volatile uint8_t *base, uint8_t bit)
+	 \brief Returns the wire attached to bit \c bit of port \c base, \c NULL if none.
+	 */
+	static OWsimWire *find(volatile uint8_t *base, uint8_t bit);
+	/**
+	 \var static OWsimWire *serialWire
+	 \brief Wire attached to a mock serial port.
+	 */
+	static OWsimWire *serialWire;
+};
+
+/**
+ \class OWsimDS18B20 OWsim.h
+ \brief Virtual DS18B20 (family 0x28) or DS18S20 (family 0x10) temperature sensor.
+ \details Implements Convert T (with its resolution dependent duration), Read/Write/Copy Scratchpad, Recall E2 and
+ Read Power Supply. During a conversion read slots return 0. Alarm flags are updated at the end of each conversion.
+ */
+class OWsimDS18B20 : public OWsimDevice {
+private:
+	int16_t _temp;
+	uint8_t _sp[9];
+	uint8_t _eeprom[3];
+	bool _busy;
+	unsigned long _busyEnd;
+	uint8_t _statusKind;
+	bool _alarm;
+	bool _converting;
+	bool _stuck;
+	// parasite power: the line is not strongly driven since _unpoweredAt
+	bool _unpowered;
+	unsigned long _unpoweredAt;
+
+	bool isS20(void);
+	void update(void);
+	void finishConversion(void);
+	void brownOut(void);
+	void setCrc(void);
+
+protected:
+	void function(uint8_t cmd);
+	void data(uint8_t i, uint8_t b);
+	uint8_t status(void);
+	bool alarm(void);
+	void power(bool strong);
+
+public:
+	/**
+	 \fn OWsimDS18B20(uint32_t serial, bool s20 = false)
+	 \brief Constructor
+	 @param serial Serial number.
+	 @param s20 \c True for a DS18S20.
+	 */
+	OWsimDS18B20(uint32_t serial, bool s20 = false);
+	/**
+	 \fn void setStuck(bool s)
+	 \brief Fault injection: the conversions never end (\c s = \c True), the device answers busy to the read slots.
+	 */
+	inline void setStuck(bool s) { _stuck = s; }
+	/**
+	 \fn void setTemperature(float c)
+	 \brief Sets the temperature (in Celsius degrees) measured by the next conversion.
+	 */
+	inline void setTemperature(float c) { _temp = (int16_t)(c * 16 + (c < 0 ? -0.5 : 0.5)); }
+	/**
+	 \fn uint16_t conversionTime(void)
+	 \brief Returns the conversion time (in milliseconds) for the current resolution.
+	 */
+	uint16_t conversionTime(void);
+	/**
+	 \fn const uint8_t *getScratchpad(void)
+	 \brief Returns the scratchpad (9 bytes).
+	 */
+	inline const uint8_t *getScratchpad(void) { return _sp; }
+	void powerCycle(void);
+};
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ \file Wire.cpp
+ \brief Host stand-in for the Arduino Wire library.
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#include "Wire.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire(void) {
+	_write = NULL;
+	_read = NULL;
+	_address = 0;
+	_txLen = _rxLen = _rxPos = 0;
+}
+
+void TwoWire::attach(HostI2CWrite w, HostI2CRead r) {
+	_write = w;
+	_read = r;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+	_address = address;
+	_txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+	if (_txLen >= HOST_WIRE_BUFFER)
+		return 0;
+	_tx[_txLen++] = b;
+	return 1;
+}
+
+uint8_t TwoWire::endTransmission(void) {
+	// about 100 us per byte at 100 kHz, address included
+	hostAdvance(100UL * (_txLen + 1));
+	if (_write)
+		_write(_address, _tx, _txLen);
+	return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t n) {
+	if (n > HOST_WIRE_BUFFER)
+		n = HOST_WIRE_BUFFER;
+	hostAdvance(100UL * (n + 1));
+	for (_rxLen = 0; _rxLen < n; _rxLen++)
+		_rx[_rxLen] = _read ? _read(address) : 0xFF;
+	_rxPos = 0;
+	return _rxLen;
+}
+
+int TwoWire::available(void) {
+	return _rxLen - _rxPos;
+}
+
+int TwoWire::read(void) {
+	return (_rxPos < _rxLen) ? _rx[_rxPos++] : -1;
+}
@@ -0,0 +1,70 @@
+/**
+ \file Wire.h
+ \brief Host stand-in for the Arduino Wire library.
+ \details The I2C transfers are handed to two callbacks standing for the devices on the bus: one receives each
+ write transaction, the other returns the bytes asked by \c requestFrom().
+ \author Enrico Formenti
+ \version 0.1
+ \date 2012-2013
+ \warning This software is provided "as is". The author is
+ not responsible for any damage of any kind caused by this
+ software. Use it at your own risk.
+ \copyright BSD license. See license.txt for more details.
+ All text above must be included in any redistribution.
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+/**
+ \def HOST_WIRE_BUFFER 32
+ \brief Longest write transaction, in bytes (the size of the AVR Wire buffer).
+ */
+#define HOST_WIRE_BUFFER 32
+
+/**
+ \typedef void (*HostI2CWrite)(uint8_t address, const uint8_t *buf, uint8_t n)
+ \brief Receives the \c n bytes written to the device at \c address in one transaction.
+ */
+typedef void (*HostI2CWrite)(uint8_t address, const uint8_t *buf, uint8_t n);
+/**
+ \typedef uint8_t (*HostI2CRead)(uint8_t address)
+ \brief Returns the next byte read from the device at \c address.
+ */
+typedef uint8_t (*HostI2CRead)(uint8_t address);
+
+/**
+ \class TwoWire Wire.h
+ \brief Mock I2C master, wired to the device callbacks given to \c attach().
+ */
+class TwoWire {
+private:
+	HostI2CWrite _write;
+	HostI2CRead _read;
+	uint8_t _address;
+	uint8_t _tx[HOST_WIRE_BUFFER];
+	uint8_t _txLen;
+	uint8_t _rx[HOST_WIRE_BUFFER];
+	uint8_t _rxLen, _rxPos;
+
+public:
+	TwoWire(void);
+	/**
+	 \fn void attach(HostI2CWrite w, HostI2CRead r)
+	 \brief Puts the devices described by \c w and \c r on the bus.
+	 */
+	void attach(HostI2CWrite w, HostI2CRead r);
+	inline void begin(void) { }
+	void beginTransmission(uint8_t address);
+	size_t write(uint8_t b);
+	uint8_t endTransmission(void);
+	uint8_t requestFrom(uint8_t address, uint8_t n);
+	int available(void);
+	int read(void);
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * \file ds2482_demo.cpp
+ * \brief Runs the DS2482 backend on a host against a mock bridge.
+ * \details The bridge is a register file behind the mock Wire library: status,
+ * read data, channel and configuration registers, a read pointer moved by the
+ * commands like on the real chip, and a 1-Wire busy flag held for a few status
+ * reads after each 1-Wire command. The program checks that the bridge is
+ * always polled through its status register, whatever the previous command
+ * left the read pointer on, and returns 0 if all the checks pass. Build and
+ * run it from this directory with:
+ * \code
+ *   g++ -std=gnu++11 -DARDUINO=100 -I. -I../.. ds2482_demo.cpp Arduino.cpp Wire.cpp \
+ *       ../../DS2482.cpp ../../I2Ccomponent.cpp ../../OWcomponent.cpp ../../OWcrc.cpp -o ds2482_demo
+ *   ./ds2482_demo
+ * \endcode
+ * \author Enrico Formenti
+ * \version 0.1
+ * \date 2012-2013
+ * \warning The author is not responsible for any damage or...
+ * caused by this software. Use it at your own risk.
+ * \copyright BSD license. See license.txt for more details.
+ * All text above must be included in any redistribution.
+ */
+
+#include <stdio.h>
+#include "Wire.h"
+#include "DS2482.h"
+
+// Status reads during which the bridge reports a 1-Wire command in progress
+#define BUSY_READS 3
+
+// Mock bridge
+static uint8_t status, data, channel, config, pointer;
+static uint8_t busy;
+static bool pullup;
+static const uint8_t *stream;
+static uint8_t streamLen, streamPos;
+static unsigned statusReads, pointerSets;
+
+static void bridgeWrite(uint8_t address, const uint8_t *buf, uint8_t n)
+{
+	static const uint8_t codes[8] = { 0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87 };
+	static const uint8_t acks[8] = { 0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87 };
+	uint8_t i;
+
+	if (address != DS2482_ADDRESS || !n)
+		return;
+	switch (buf[0]) {
+	case DS2482_CMD_DEVICE_RESET:
+		status = DS2482_STATUS_RST;
+		config = 0;
+		channel = acks[0];
+		pointer = DS2482_REG_STATUS;
+		break;
+	case DS2482_CMD_SET_READ_POINTER:
+		pointer = buf[1];
+		pointerSets++;
+		break;
+	case DS2482_CMD_WRITE_CONFIG:
+		// reads back with the upper nibble cleared
+		config = buf[1] & 0x0F;
+		pointer = DS2482_REG_CONFIG;
+		if (!(config & DS2482_CONFIG_SPU))
+			pullup = false;
+		break;
+	case DS2482_CMD_CHANNEL_SELECT:
+		for (i = 0; i < 8; i++)
+			if (codes[i] == buf[1])
+				channel = acks[i];
+		pointer = DS2482_REG_CHANNEL;
+		break;
+	case DS2482_CMD_1WIRE_RESET:
+		// any 1-Wire command ends the strong pullup, the bridge clears SPU
+		if (pullup)
+			config &= ~DS2482_CONFIG_SPU;
+		pullup = false;
+		status = DS2482_STATUS_PPD;
+		busy = BUSY_READS;
+		pointer = DS2482_REG_STATUS;
+		break;
+	case DS2482_CMD_1WIRE_READ_BYTE:
+		data = (streamPos < streamLen) ? stream[streamPos++] : 0xFF;
+		// fall through
+	case DS2482_CMD_1WIRE_WRITE_BYTE:
+	case DS2482_CMD_1WIRE_SINGLE_BIT:
+	case DS2482_CMD_1WIRE_TRIPLET:
+		if (pullup)
+			config &= ~DS2482_CONFIG_SPU;
+		// SPU set: the strong pullup starts after this command
+		pullup = (config & DS2482_CONFIG_SPU) != 0;
+		status &= ~DS2482_STATUS_RST;
+		busy = BUSY_READS;
+		pointer = DS2482_REG_STATUS;
+		break;
+	}
+}
+
+static uint8_t bridgeRead(uint8_t address)
+{
+	if (address != DS2482_ADDRESS)
+		return 0xFF;
+	switch (pointer) {
+	case DS2482_REG_STATUS:
+		statusReads++;
+		if (busy) {
+			busy--;
+			return status | DS2482_STATUS_1WB;
+		}
+		return status;
+	case DS2482_REG_DATA:
+		return data;
+	case DS2482_REG_CHANNEL:
+		return channel;
+	case DS2482_REG_CONFIG:
+		return config;
+	}
+	return 0xFF;
+}
+
+static uint8_t failures = 0;
+
+static void check(const char *what, bool ok)
+{
+	printf("  %-50s %s\n", what, ok ? "ok" : "FAIL");
+	if (!ok)
+		failures++;
+}
+
+int main(void)
+{
+	static const uint8_t bytes[4] = { 0x01, 0x03, 0xFF, 0x55 };
+	uint8_t buf[4];
+
+	Wire.attach(bridgeWrite, bridgeRead);
+	DS2482 bridge;
+
+	printf("DS2482\n");
+	check("begin()", bridge.begin() && config == DS2482_CONFIG_APU);
+
+	// the configuration register reads 0x01 (APU), which looks busy
+	statusReads = 0;
+	check("reset after begin(): presence", bridge.reset() == 1 && bridge.getError() == ERROR_NONE);
+	check("reset after begin(): status register polled", statusReads <= 2 * (BUSY_READS + 1));
+
+	// the acknowledge of channel 1 (0xB1) looks busy too
+	check("channel 1 selected", bridge.selectChannel(1) && bridge.getChannel() == 1);
+	statusReads = 0;
+	check("reset after selectChannel(1): presence", bridge.reset() == 1 && bridge.getError() == ERROR_NONE);
+	check("reset after selectChannel(1): status register polled", statusReads <= 2 * (BUSY_READS + 1));
+
+	// each byte read leaves the pointer on the data register
+	stream = bytes;
+	streamLen = sizeof(bytes);
+	streamPos = 0;
+	statusReads = pointerSets = 0;
+	bridge.read_bytes(buf, sizeof(buf));
+	check("4 bytes read", !memcmp(buf, bytes, sizeof(bytes)) && bridge.getError() == ERROR_NONE);
+	// to the data register for each byte, back to the status register before the next one
+	check("read pointer moved only when needed", pointerSets == 2 * sizeof(bytes) - 1);
+	check("no poll wasted", statusReads <= 2 * sizeof(bytes) * (BUSY_READS + 1));
+
+	// strong pullup: the configuration is written around the byte
+	bridge.write(0x44, 1);
+	bridge.depower();
+	check("strong pullup set and cleared", !(config & DS2482_CONFIG_SPU) && bridge.getError() == ERROR_NONE);
+	check("next reset: presence", bridge.reset() == 1 && bridge.getError() == ERROR_NONE);
+
+	// consecutive 1-Wire commands leave the pointer alone
+	pointerSets = 0;
+	bridge.reset();
+	bridge.write(0xCC);
+	bridge.write(0x44);
+	check("no pointer move between 1-Wire commands", pointerSets == 0 && bridge.getError() == ERROR_NONE);
+
+	// the bridge ends the pullup by itself, a later configuration must not start it again
+	bridge.write(0x44, 1);
+	check("strong pullup on", pullup && (config & DS2482_CONFIG_SPU));
+	bridge.reset();
+	check("strong pullup ended by the reset", !pullup && !(config & DS2482_CONFIG_SPU));
+	bridge.setSpeed(OW_SPEED_OVERDRIVE);
+	bridge.setSpeed(OW_SPEED_STANDARD);
+	check("speed change: strong pullup left off", !(config & DS2482_CONFIG_SPU) && !pullup);
+	bridge.depower();
+	check("depower(): nothing to release", bridge.getError() == ERROR_NONE);
+
+	printf("%u failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
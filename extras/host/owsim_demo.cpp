@@ -0,0 +1,851 @@
+/**
+ * \file owsim_demo.cpp
+ * \brief Runs the library on a host against the 1-Wire simulator.
+ * \details Virtual DS18B20 and DS18S20 sensors are put on simulated wires and
+ * driven by the unchanged bit-banging code (and by OWuart through a mock
+ * serial port, and OWmultibus on several wires of the same port). For each operation the program prints the simulated bus time,
+ * then checks the results, including with faults injected. It returns 0 if all
+ * the checks pass. Build and run it from this directory with:
+ * \code
+ *   g++ -std=gnu++11 -DARDUINO=100 -DONEWIRE_SIM -I. -I../.. owsim_demo.cpp OWsim.cpp \
+ *       Arduino.cpp ../../OWcomponent.cpp ../../OWcrc.cpp ../../OWuart.cpp \
+ *       ../../DS18B20.cpp ../../DS18B20group.cpp ../../DS18B20fleet.cpp ../../OWrediscovery.cpp \
+ *       ../../OWmultibus.cpp -o owsim_demo
+ *   ./owsim_demo
+ * \endcode
+ * \author Enrico Formenti
+ * \version 0.1
+ * \date 2012-2013
+ * \warning The author is not responsible for any damage or...
+ * caused by this software. Use it at your own risk.
+ * \copyright BSD license. See license.txt for more details.
+ * All text above must be included in any redistribution.
+ */
+
+#include <stdio.h>
+#include "OWsim.h"
+#include "OWuart.h"
+#include "OWmultibus.h"
+#include "DS18B20.h"
+#include "DS18S20.h"
+#include "DS18B20group.h"
+#include "DS18B20fleet.h"
+#include "OWrediscovery.h"
+
+static const OWtransaction txn_read_scratchpad =
+	{ OW_TXN_RESET | OW_TXN_MATCH | OW_TXN_CRC8, 1, { CMD_READ_SCRATCHPAD }, 0, 9 };
+static const OWtransaction txn_read_scratchpad_skip =
+	{ OW_TXN_RESET | OW_TXN_SKIP | OW_TXN_CRC8, 1, { CMD_READ_SCRATCHPAD }, 0, 9 };
+static const OWtransaction txn_read_crc16 =
+	{ OW_TXN_RESET | OW_TXN_MATCH | OW_TXN_CRC16, 1, { CMD_READ_SCRATCHPAD }, 0, 4 };
+static const OWtransaction txn_convert =
+	{ OW_TXN_RESET | OW_TXN_MATCH, 1, { CMD_START_CONVERSION }, 0, 0 };
+
+static uint8_t failures = 0;
+
+static void check(const char *what, bool ok)
+{
+	printf("  %-52s %s\n", what, ok ? "ok" : "FAIL");
+	if (!ok)
+		failures++;
+}
+
+static void bench(const char *what, unsigned long t0)
+{
+	printf("  %-52s %8lu us\n", what, micros() - t0);
+}
+
+//
+// DS18B20 class on a bus of its own
+//
+static void sensor(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 dev(0x1001);
+	OWstats stats;
+	unsigned long t0;
+	uint8_t i;
+	float t;
+
+	printf("DS18B20, external power\n");
+	wire.attach(2);
+	wire.add(dev);
+	dev.setTemperature(23.5625);
+
+	DS18B20 s(2);
+	t0 = micros();
+	s.begin();
+	bench("begin()", t0);
+	check("address found", !memcmp(s.getAddress(), dev.getRom(), 8));
+	check("not parasite powered", !s.isParasiteMode());
+	check("12 bits resolution", s.getResolution() == 12);
+
+	t0 = micros();
+	t = s.getTemperature();
+	bench("getTemperature(), 12 bits", t0);
+	check("23.5625 C read", t == 23.5625);
+
+	s.setResolution(9);
+	check("resolution set to 9 bits", s.getResolution() == 9 && (dev.getScratchpad()[CONFIGURATION] & 0x60) == 0);
+	t0 = micros();
+	t = s.getTemperature();
+	bench("getTemperature(), 9 bits", t0);
+	check("23.5 C read", t == 23.5);
+
+	// the main loop goes on during the conversion
+	dev.setTemperature(30.5);
+	t0 = micros();
+	check("startConversion()", s.startConversion());
+	check("not ready at once", !s.isConversionReady());
+	while (!s.isConversionReady())
+		;
+	bench("startConversion() until ready, 9 bits", t0);
+	check("30.5 C read", s.readTemperature() == 30.5);
+	printf("  measured conversion time %u ms\n", s.getConversionTime());
+	check("completion seen by read slots", s.getConversionTime() <= dev.conversionTime() + 1);
+
+	// integer API, negative temperature
+	static_assert(DS18B20::rawToCenti(-162) == -1013 && DS18B20::centiToRaw(-1013) == -162, "constexpr helpers");
+	dev.setTemperature(-10.125);
+	s.setResolution(10);
+	check("-10.25 C read in 1/16 at 10 bits", s.getRawTemperature() == -164);
+	check("-10.25 C read in 1/100", s.readCentiTemperature() == -1025);
+	check("-10.25 C read as float", s.readTemperature() == -10.25);
+	s.setResolution(12);
+	check("-10.125 C read in 1/16 at 12 bits", s.getRawTemperature() == -162);
+	dev.setTemperature(30.5);
+
+	// fast read: two bytes, no CRC
+	t0 = micros();
+	s.readRawTemperature(false);
+	bench("readRawTemperature(), whole scratchpad", t0);
+	t0 = micros();
+	check("-10.125 C fast read", s.readRawTemperature(true) == -162);
+	bench("readRawTemperature(), fast", t0);
+
+	// settings kept in EEPROM across a power cycle
+	s.clearStats();
+	s.setResolution(12);
+	s.getStats(&stats);
+	check("same resolution: nothing sent", stats.resets == 0);
+	s.setResolution(11);
+	check("changed resolution not saved", !s.isConfigSaved());
+	check("saveConfig()", s.saveConfig() && s.isConfigSaved());
+	dev.powerCycle();
+	s.begin();
+	check("11 bits after a power cycle", s.getResolution() == 11 && s.isConfigSaved());
+	s.setResolution(10);
+	check("recallConfig() drops the change", s.recallConfig() && s.getResolution() == 11);
+	s.setResolution(12);
+	s.saveConfig();
+
+	// adaptive resolution: 9 bits at least, 400 ms at most
+	check("latency budget below 9 bits refused", !s.setAdaptive(9, 50));
+	check("setAdaptive(9, 400)", s.setAdaptive(9, 400) && s.getResolution() == 9);
+	dev.setTemperature(20);
+	for (i = 0; i < 4; i++)
+		s.getRawTemperature();
+	check("stable: up to 11 bits", s.getResolution() == 11);
+	dev.setTemperature(25);
+	t0 = micros();
+	s.getRawTemperature();
+	bench("step: reading at 11 bits", t0);
+	check("step: back to 9 bits", s.getResolution() == 9);
+	t0 = micros();
+	check("step: 25 C read", s.getRawTemperature() == 400);
+	bench("step: reading at 9 bits", t0);
+	s.clearAdaptive();
+	s.setResolution(12);
+	dev.setTemperature(30.5);
+
+	// once the bus is reset the sensor does not answer: the longest time is waited
+	s.startConversion();
+	s.reset();
+	while (!s.isConversionReady())
+		;
+	check("bus reset: no time out", s.getError() == ERROR_NONE && s.readTemperature() == 30.5);
+
+	// a conversion that never ends is reported by the blocking calls
+	dev.setStuck(true);
+	dev.setTemperature(31);
+	t0 = micros();
+	check("stuck conversion: getRawTemperature() fails", s.getRawTemperature() == 0
+		&& s.getError() == ERROR_TIME_OUT);
+	check("stuck conversion: longest time waited", micros() - t0 >= DS18B20_CONVERSION_TIME * 1000UL);
+	check("stuck conversion: stale value not read", s.readRawTemperature() == 0 && s.getError() == ERROR_TIME_OUT);
+	check("stuck conversion: getTemperature() fails", s.getTemperature() == 0 && s.getError() == ERROR_TIME_OUT);
+	dev.setStuck(false);
+	check("next conversion: time out cleared", s.getRawTemperature() == 31 * 16 && s.getError() == ERROR_NONE);
+
+	// the alarm compares the signed temperature with the bounds
+	s.setAlarm(10, 30);
+	dev.setTemperature(20);
+	s.getRawTemperature();
+	check("alarm: in range", !s.isAlarmTriggered() && s.getError() == ERROR_NONE);
+	dev.setTemperature(30.5);
+	s.getRawTemperature();
+	s.clearStats();
+	check("alarm: above the high bound", s.isAlarmTriggered());
+	s.getStats(&stats);
+	check("alarm: bus not used", stats.resets == 0 && stats.bytesRead == 0);
+	dev.setTemperature(20);
+	s.getRawTemperature();
+	check("alarm: kept until reset", s.isAlarmTriggered());
+	s.resetAlarm();
+	s.setAlarm(-10, 30);
+	dev.setTemperature(-9);
+	s.getRawTemperature();
+	check("alarm: negative, in range", !s.isAlarmTriggered());
+	s.setAlarm(-10, 30);
+	dev.setTemperature(-10.5);
+	s.getRawTemperature();
+	check("alarm: below the low bound", s.isAlarmTriggered());
+	s.resetAlarm();
+}
+
+//
+// Parasite power: the conversion needs the strong pullup
+//
+static void parasite(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 dev(0x2001);
+	OWcomponent ow(3);
+	uint8_t sp[9];
+	unsigned long t0;
+
+	printf("DS18B20, parasite power\n");
+	wire.attach(3);
+	wire.add(dev);
+	dev.setParasite(true);
+	dev.setTemperature(-10.125);
+
+	t0 = micros();
+	ow.execute(&txn_convert, dev.getRom(), NULL, OW_TXN_PULLUP);
+	ow.strong_pullup(dev.conversionTime());
+	ow.execute(&txn_read_scratchpad, dev.getRom(), sp);
+	bench("conversion with strong pullup", t0);
+	check("-10.125 C read", (int16_t)((sp[TEMP_MSB] << 8) | sp[TEMP_LSB]) == -162);
+
+	// without the pullup the device browns out and keeps its power-on value
+	dev.powerCycle();
+	ow.execute(&txn_convert, dev.getRom());
+	delay(dev.conversionTime());
+	ow.execute(&txn_read_scratchpad, dev.getRom(), sp);
+	check("no pullup: power-on value (85 C) read", sp[TEMP_MSB] == 0x05 && sp[TEMP_LSB] == 0x50);
+}
+
+//
+// DS18S20: 0.5 degree register, counters for the extended resolution
+//
+static void ds18s20(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 dev(0x8001, true);
+	OWcomponent ow(8);
+	uint8_t sp[9];
+	float t;
+
+	printf("DS18S20\n");
+	wire.attach(8);
+	wire.add(dev);
+	dev.setTemperature(-0.4375);
+
+	ow.execute(&txn_convert, dev.getRom());
+	delay(dev.conversionTime());
+	check("read scratchpad", ow.execute(&txn_read_scratchpad, dev.getRom(), sp) == ERROR_NONE);
+	check("0.5 degree register", sp[TEMP_LSB] == 0xFF && sp[TEMP_MSB] == 0xFF);
+	t = (float)((int16_t)((sp[TEMP_MSB] << 8) | sp[TEMP_LSB]) >> 1) - 0.25
+		+ (float)(sp[COUNT_PER_C] - sp[COUNT_REMAIN]) / sp[COUNT_PER_C];
+	check("-0.4375 C with the extended resolution", t == -0.4375);
+
+	// same through the driver, in fixed point
+	DS18S20 s(8);
+	s.begin();
+	check("DS18S20 found", s.isDS18S20() && s.getResolution() == 9);
+	check("reported as a DS18S20", s.isComponent(S_DS18S20, ST_TEMPERATURE));
+	s.begin(FAM_CODE_DB18S20);
+	check("begin(family) still available", s.isDS18S20() && s.getError() == ERROR_NONE);
+	check("-7/16 C", s.getRawTemperature() == -7 && s.getError() == ERROR_NONE);
+	dev.setTemperature(23.75);
+	check("23.75 C", s.getCentiTemperature() == 2375);
+	s.setResolution(12);
+	check("resolution fixed to 9 bits", s.getResolution() == 9 && s.getError() == ERROR_OUT_OF_RANGE);
+	s.setAlarm(-5, 30);
+	check("alarms", s.execute(&txn_read_scratchpad, dev.getRom(), sp) == ERROR_NONE
+		&& (int8_t)sp[HIGH_ALARM_TEMP] == 30 && (int8_t)sp[LOW_ALARM_TEMP] == -5);
+}
+
+//
+// 20 sensors converting in parallel
+//
+#define GROUP_SIZE 20
+
+static void group(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 *dev[GROUP_SIZE];
+	OWcomponent ow(9);
+	uint8_t roms[GROUP_SIZE][8], i, j, n;
+	int16_t raw[GROUP_SIZE];
+	uint16_t status[GROUP_SIZE];
+	unsigned long t0;
+	bool ok = true;
+
+	printf("DS18B20group, %u sensors\n", GROUP_SIZE);
+	wire.attach(9);
+	for (i = 0; i < GROUP_SIZE; i++) {
+		dev[i] = new OWsimDS18B20(0x9000 + i);
+		dev[i]->setTemperature(20 + i * 0.25);
+		wire.add(*dev[i]);
+	}
+
+	DS18B20group g(ow, roms, GROUP_SIZE);
+	check("20 sensors found", g.discover() == GROUP_SIZE);
+	t0 = micros();
+	n = g.readAll(raw, status);
+	bench("readAll()", t0);
+	check("one cycle under 1 s", micros() - t0 < 1000000UL);
+	for (i = 0; i < GROUP_SIZE; i++) {
+		j = g.indexOf(dev[i]->getRom());
+		ok = ok && j != 0xFF && status[j] == ERROR_NONE && raw[j] == 320 + i * 4;
+	}
+	check("all the sensors read", n == GROUP_SIZE && ok);
+
+	g.setFastRead(true);
+	t0 = micros();
+	for (i = 0; i < GROUP_SIZE; i++)
+		g.read(i, &raw[i]);
+	bench("20 fast reads", t0);
+	g.setFastRead(false);
+	t0 = micros();
+	for (i = 0; i < GROUP_SIZE; i++)
+		g.read(i, &raw[i]);
+	bench("20 reads with CRC", t0);
+
+	// an unplugged sensor only fails its own read
+	dev[5]->connect(false);
+	n = g.readAll(raw, status);
+	check("unplugged sensor reported", n == GROUP_SIZE - 1 && status[g.indexOf(dev[5]->getRom())] != ERROR_NONE);
+	dev[5]->connect(true);
+
+	// a sensor stuck in its conversion holds the bus low for all of them:
+	// nobody can be trusted until the next conversion
+	dev[3]->setStuck(true);
+	for (i = 0; i < GROUP_SIZE; i++)
+		dev[i]->setTemperature(30);
+	n = g.readAll(raw, status);
+	for (i = 0, ok = true; i < GROUP_SIZE; i++)
+		ok = ok && status[i] == ERROR_TIME_OUT;
+	check("stuck sensor: readAll() times out", n == 0 && ok && g.getError() == ERROR_TIME_OUT);
+	check("stuck sensor: stale value not read", g.read(0, &raw[0]) == ERROR_TIME_OUT);
+	dev[3]->setStuck(false);
+	n = g.readAll(raw, status);
+	check("next conversion: time out cleared", n == GROUP_SIZE && raw[0] == 30 * 16);
+
+	for (i = 0; i < GROUP_SIZE; i++)
+		delete dev[i];
+}
+
+//
+// DS18B20 and DS18S20 on the same bus
+//
+#define MIXED_SIZE 6
+
+static void mixed(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 *dev[MIXED_SIZE];
+	OWcomponent ow(14);
+	uint8_t roms[MIXED_SIZE][8], i, j, n;
+	int16_t raw[MIXED_SIZE];
+	uint16_t status[MIXED_SIZE];
+	bool ok = true;
+
+	printf("DS18B20group, mixed families\n");
+	wire.attach(14);
+	for (i = 0; i < MIXED_SIZE; i++) {
+		dev[i] = new OWsimDS18B20(0xE000 + i, i & 1);
+		dev[i]->setTemperature(-10 + i * 3.0625);
+		wire.add(*dev[i]);
+	}
+
+	DS18B20group g(ow, roms, MIXED_SIZE);
+	check("both families found", g.discover() == MIXED_SIZE);
+	n = g.readAll(raw, status);
+	for (i = 0; i < MIXED_SIZE; i++) {
+		j = g.indexOf(dev[i]->getRom());
+		ok = ok && j != 0xFF && status[j] == ERROR_NONE && raw[j] == -160 + i * 49;
+	}
+	check("one batched read, 1/16 C for all", n == MIXED_SIZE && ok);
+
+	g.setFastRead(true);
+	for (i = 0; i < MIXED_SIZE; i++)
+		g.read(i, &raw[i]);
+	j = g.indexOf(dev[1]->getRom());
+	check("fast read of a DS18S20, 0.5 C steps", raw[j] == -112);
+
+	for (i = 0; i < MIXED_SIZE; i++)
+		delete dev[i];
+}
+
+//
+// Several sensors, alarm search
+//
+static uint8_t alarms;
+
+static void onAlarm(uint8_t /* index */, uint8_t /* rom */[8], int16_t /* raw */)
+{
+	alarms++;
+}
+
+static void fleet(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 dev[4] = { OWsimDS18B20(0x3001), OWsimDS18B20(0x3002), OWsimDS18B20(0x3003),
+		OWsimDS18B20(0x3004) };
+	OWcomponent ow(4);
+	uint8_t roms[4][8];
+	unsigned long t0;
+
+	printf("DS18B20fleet, one sensor parasite powered\n");
+	wire.attach(4);
+	for (uint8_t i = 0; i < 4; i++)
+		wire.add(dev[i]);
+	dev[3].setParasite(true);
+	dev[0].setTemperature(25);
+	dev[1].setTemperature(35);
+	dev[2].setTemperature(10);
+	dev[3].setTemperature(29.5);
+
+	DS18B20fleet f(ow, roms, 4);
+	t0 = micros();
+	check("4 sensors found", f.discover() == 4);
+	bench("discover()", t0);
+	check("parasite power detected", f.isParasiteMode());
+	check("alarms set", f.setAlarms(20, 30));
+	f.onAlarm(onAlarm);
+	t0 = micros();
+	check("2 sensors in alarm", f.poll() == 2 && alarms == 2);
+	bench("poll()", t0);
+}
+
+//
+// Power-on value, bad frames and jumps rejected, retries
+//
+#define CHECKED_SIZE 4
+
+static void validation(void)
+{
+	OWsimWire wire, gwire;
+	OWsimDS18B20 dev(0xC001), *gdev[CHECKED_SIZE];
+	OWcomponent ow(16);
+	uint8_t roms[CHECKED_SIZE][8], i, n;
+	int16_t raw[CHECKED_SIZE], last[CHECKED_SIZE];
+	uint16_t status[CHECKED_SIZE];
+	static const uint8_t zeros[9] = { 0 };
+	static const uint8_t ones[9] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+	unsigned long t0;
+	bool ok = true;
+
+	printf("Reading validation\n");
+	check("all-zeros frame rejected",
+		DS18B20::checkReading(zeros, 9, 0, DS18B20_NO_SAMPLE, DS18B20_NO_SAMPLE, DS18B20_MAX_JUMP) == ERROR_READ_FAILURE);
+	check("all-ones frame rejected",
+		DS18B20::checkReading(ones, 9, -1, DS18B20_NO_SAMPLE, DS18B20_NO_SAMPLE, DS18B20_MAX_JUMP) == ERROR_READ_FAILURE);
+	check("-0.0625 C fast read accepted",
+		DS18B20::checkReading(ones, 2, -1, DS18B20_NO_SAMPLE, DS18B20_NO_SAMPLE, DS18B20_MAX_JUMP) == ERROR_NONE);
+	check("0 C fast read accepted",
+		DS18B20::checkReading(zeros, 2, 0, DS18B20_NO_SAMPLE, DS18B20_NO_SAMPLE, DS18B20_MAX_JUMP) == ERROR_NONE);
+
+	wire.attach(15);
+	wire.add(dev);
+	dev.setTemperature(21.5);
+	DS18B20 s(15);
+	s.begin();
+	check("first reading", s.getRawTemperature() == 344);
+
+	// brownout between the conversion and the read
+	s.startConversion();
+	while (!s.isConversionReady())
+		;
+	dev.powerCycle();
+	t0 = micros();
+	check("power-on value: converted again", s.readRawTemperature(false) == 344 && s.getError() == ERROR_NONE);
+	bench("readRawTemperature() after a brownout", t0);
+	dev.powerCycle();
+	s.setValidation(DS18B20_MAX_JUMP, 0);
+	check("no retry: power-on value reported", s.readRawTemperature(false) == 0
+		&& s.getError() == ERROR_POWER_ON_RESET);
+	s.setValidation(DS18B20_MAX_JUMP, DS18B20_RETRIES);
+
+	// a real step is confirmed by the new conversion
+	dev.setTemperature(45);
+	check("jump confirmed", s.getRawTemperature() == 720 && s.getError() == ERROR_NONE);
+
+	// a group only retries the sensor concerned
+	gwire.attach(16);
+	for (i = 0; i < CHECKED_SIZE; i++) {
+		gdev[i] = new OWsimDS18B20(0xC100 + i);
+		gdev[i]->setTemperature(18 + i);
+		gwire.add(*gdev[i]);
+	}
+	DS18B20group g(ow, roms, CHECKED_SIZE);
+	g.discover();
+	g.setValidation(last);
+	n = g.readAll(raw, status);
+	check("history filled", n == CHECKED_SIZE && last[g.indexOf(gdev[2]->getRom())] == 320);
+
+	g.convert();
+	gdev[2]->powerCycle();
+	t0 = micros();
+	for (i = 0; i < CHECKED_SIZE; i++)
+		ok = ok && g.read(g.indexOf(gdev[i]->getRom()), &raw[i]) == ERROR_NONE && raw[i] == 288 + i * 16;
+	bench("4 reads, one sensor converted again", t0);
+	check("browned out sensor retried alone", ok && micros() - t0 < 2 * DS18B20_CONVERSION_TIME * 1000UL);
+
+	for (i = 0; i < CHECKED_SIZE; i++)
+		delete gdev[i];
+}
+
+//
+// Where the time goes, per sensor
+//
+#define PROFILED_SIZE 3
+
+static void profile(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 *dev[PROFILED_SIZE];
+	OWcomponent ow(17);
+	uint8_t roms[PROFILED_SIZE][8], i, j;
+	int16_t raw[PROFILED_SIZE];
+	DS18B20stats stats[PROFILED_SIZE], st;
+
+	printf("Per-sensor profiling\n");
+	wire.attach(17);
+	for (i = 0; i < PROFILED_SIZE; i++) {
+		dev[i] = new OWsimDS18B20(0xD000 + i);
+		dev[i]->setTemperature(20);
+		wire.add(*dev[i]);
+	}
+
+	DS18B20 s(17);
+	s.begin();
+	s.setResolution(10);
+	s.getRawTemperature();
+	s.getRawTemperature();
+	s.getSensorStats(&st);
+	printf("  conversion %u ms (max %u), read %u us (max %u), select %u us\n",
+		st.convLast, st.convMax, st.readLast, st.readMax, st.selectLast);
+	check("sensor: conversion and read timed", st.reads == 2 && st.convLast > 0
+		&& st.convLast <= dev[0]->conversionTime() + 1 && st.readLast > st.selectLast && st.selectLast > 0);
+	s.setFastRead(true);
+	s.readRawTemperature();
+	s.getSensorStats(&st);
+	check("sensor: fast read shorter", st.readLast < st.readMax);
+	s.clearSensorStats();
+	s.getSensorStats(&st);
+	check("sensor: cleared", st.reads == 0 && st.convMax == 0);
+
+	DS18B20group g(ow, roms, PROFILED_SIZE);
+	g.discover();
+	g.setStats(stats);
+	g.readAll(raw);
+	check("group: broadcast conversion accounted to all",
+		stats[0].convLast > 0 && stats[0].convLast == stats[2].convLast && stats[1].reads == 1);
+
+	// retries and CRC failures of the noisy sensor only
+	j = g.indexOf(dev[1]->getRom());
+	dev[1]->setFlipRate(20);
+	g.read(j, &raw[j]);
+	dev[1]->setFlipRate(0);
+	printf("  noisy sensor: %u reads, %u CRC errors, %u retries\n", stats[j].reads, stats[j].crcErrors,
+		stats[j].retries);
+	check("group: CRC errors and retries counted", stats[j].crcErrors > 0 && stats[j].retries > 0
+		&& stats[(j + 1) % PROFILED_SIZE].crcErrors == 0);
+
+	// a conversion of one sensor is accounted to it only
+	for (i = 0; i < PROFILED_SIZE; i++)
+		stats[i].convLast = 0;
+	dev[2]->powerCycle();
+	j = g.indexOf(dev[2]->getRom());
+	g.read(j, &raw[j]);
+	i = (j + 1) % PROFILED_SIZE;
+	check("group: reconversion accounted to its sensor only", stats[j].reconversions == 1
+		&& stats[j].convLast > 0 && stats[j].convLast <= dev[2]->conversionTime() + 1
+		&& stats[i].reconversions == 0 && stats[i].convLast == 0);
+
+	for (i = 0; i < PROFILED_SIZE; i++)
+		delete dev[i];
+}
+
+//
+// Fault injection
+//
+static void faults(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 dev(0x4001);
+	OWcomponent ow(5);
+	OWstats stats;
+	uint8_t sp[9], i, good = 0;
+	OWcalibration cal;
+	OWtiming def;
+	uint16_t select;
+	uint8_t mask[9];
+
+	printf("Fault injection\n");
+	wire.attach(5);
+	wire.add(dev);
+
+	dev.setFlipRate(500);
+	for (i = 0; i < 20; i++)
+		if (ow.execute(&txn_read_scratchpad, dev.getRom(), sp) == ERROR_NONE)
+			good++;
+	ow.getStats(&stats);
+	check("flipped bits: CRC errors counted", stats.crc8Errors > 0 && stats.crc8Errors == 20 - good);
+	dev.setFlipRate(0);
+
+	wire.setShort(true);
+	ow.clearStats();
+	check("short: no presence", !ow.reset());
+	ow.getStats(&stats);
+	check("short: counted", stats.shorts == 1);
+	wire.setShort(false);
+
+	ow.execute(&txn_read_scratchpad, dev.getRom(), sp);
+	select = ow.getSelectTime();
+	dev.connect(false);
+	ow.clearStats();
+	check("device gone: no presence", ow.execute(&txn_read_scratchpad, dev.getRom(), sp) == ERROR_NO_PRESENCE);
+	ow.getStats(&stats);
+	check("device gone: counted", stats.noPresence == 1);
+	printf("  select time %u us, reset alone %u us\n", select, ow.getSelectTime());
+	check("device gone: select time of the reset alone", ow.getSelectTime() && ow.getSelectTime() < select);
+	dev.connect(true);
+
+	// the scratchpad has no CRC16: the check is either done or refused
+#if ONEWIRE_CRC && ONEWIRE_CRC16
+	check("CRC16 checked", ow.execute(&txn_read_crc16, dev.getRom(), sp) == ERROR_INVALID_CRC);
+#else
+	check("CRC16 disabled: refused", ow.execute(&txn_read_crc16, dev.getRom(), sp) == ERROR_NOT_SUPPORTED);
+#endif
+
+	// a mask without expected bytes compares nothing
+	memset(mask, 0xFF, sizeof(mask));
+	ow.reset();
+	ow.select(dev.getRom());
+	ow.write(CMD_READ_SCRATCHPAD);
+	check("mask without expected bytes ignored", ow.read_bytes_crc8(sp, 9, NULL, mask) && !memcmp(sp, dev.getScratchpad(), 9));
+
+	// the slow edge turns the 1 bits into 0 bits: all zeros has a valid CRC
+	wire.setRiseTime(12);
+	ow.execute(&txn_read_scratchpad, dev.getRom(), sp);
+	check("slow rising edge: default timings fail", memcmp(sp, dev.getScratchpad(), 9));
+	check("slow rising edge: calibrate()", ow.calibrate());
+	ow.getCalibration(&cal);
+	printf("  sample delay %u us, recovery %u us\n", cal.readSample, cal.readRecovery);
+	OWcomponent::defaultTiming(OW_SPEED_STANDARD, &def);
+	check("slow rising edge: whole slot and default recovery kept", cal.readRecovery >= def.readRecovery
+		&& def.readLow + cal.readSample + cal.readRecovery >= OW_SLOT_MIN);
+	wire.clearViolations();
+	ow.execute(&txn_read_scratchpad, dev.getRom(), sp);
+	check("slow rising edge: calibrated timings work", !memcmp(sp, dev.getScratchpad(), 9)
+		&& !wire.getViolations());
+
+	// read slots shorter than tSLOT + tREC: the device misses some of them
+	cal.speed = OW_SPEED_STANDARD;
+	cal.readSample = 25;
+	cal.readRecovery = 1;
+	cal.crc = ~OWcomponent::crc8((uint8_t *)&cal, 3);
+	ow.setCalibration(&cal);
+	check("29 us read slots: transfer corrupted", ow.execute(&txn_read_scratchpad, dev.getRom(), sp) != ERROR_NONE
+		|| memcmp(sp, dev.getScratchpad(), 9));
+	check("29 us read slots: violations reported", wire.getViolations() > 0);
+}
+
+//
+// Overdrive (the DS18B20 does not support it, the virtual one can)
+//
+static void overdrive(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 dev(0x5001);
+	OWcomponent ow(6);
+	uint8_t sp[9];
+	unsigned long t0;
+
+	printf("Overdrive\n");
+	wire.attach(6);
+	wire.add(dev);
+	dev.setOverdrive(true);
+
+	t0 = micros();
+	check("read scratchpad, standard speed", ow.execute(&txn_read_scratchpad_skip, NULL, sp) == ERROR_NONE);
+	bench("read scratchpad, standard speed", t0);
+
+	ow.reset();
+	ow.overdrive_skip();
+	t0 = micros();
+	check("read scratchpad, overdrive speed", ow.execute(&txn_read_scratchpad_skip, NULL, sp) == ERROR_NONE);
+	bench("read scratchpad, overdrive speed", t0);
+	ow.setSpeed(OW_SPEED_STANDARD);
+}
+
+//
+// Hot plug
+//
+static uint8_t added, removed;
+
+static void onAdded(uint8_t /* rom */[8])
+{
+	added++;
+}
+
+static void onRemoved(uint8_t /* rom */[8])
+{
+	removed++;
+}
+
+static void sweep(OWrediscovery &r)
+{
+	uint16_t n = 0;
+
+	while (!r.poll() && ++n < 1000)
+		;
+}
+
+static void hotplug(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 dev[3] = { OWsimDS18B20(0x6001), OWsimDS18B20(0x6002), OWsimDS18B20(0x6003) };
+	OWcomponent ow(7);
+	uint8_t roms[4][8];
+	unsigned long t0;
+
+	printf("OWrediscovery\n");
+	wire.attach(7);
+	for (uint8_t i = 0; i < 3; i++)
+		wire.add(dev[i]);
+	dev[2].connect(false);
+
+	OWrediscovery r(ow, roms, 4);
+	r.onAdded(onAdded);
+	r.onRemoved(onRemoved);
+	t0 = micros();
+	sweep(r);
+	bench("sweep, 2 devices", t0);
+	check("2 devices found", r.getCount() == 2 && added == 2);
+
+	dev[2].connect(true);
+	sweep(r);
+	check("plugged device found", r.getCount() == 3 && added == 3 && r.indexOf(dev[2].getRom()) != 0xFF);
+
+	dev[0].connect(false);
+	sweep(r);
+	check("unplugged device removed", r.getCount() == 2 && removed == 1 && r.indexOf(dev[0].getRom()) == 0xFF);
+}
+
+//
+// OWuart through a mock serial port
+//
+static void uart(void)
+{
+	OWsimWire wire;
+	OWsimDS18B20 dev(0x7001);
+	uint8_t sp[9];
+	unsigned long t0;
+
+	printf("OWuart\n");
+	wire.attach(Serial1);
+	wire.add(dev);
+	dev.setTemperature(21.25);
+
+	OWuart ow(Serial1);
+	ow.begin();
+	ow.execute(&txn_convert, dev.getRom());
+	delay(dev.conversionTime());
+	t0 = micros();
+	check("read scratchpad", ow.execute(&txn_read_scratchpad, dev.getRom(), sp) == ERROR_NONE);
+	bench("read scratchpad", t0);
+	check("21.25 C read", (int16_t)((sp[TEMP_MSB] << 8) | sp[TEMP_LSB]) == 340);
+	ow.reset();
+	ow.skip();
+	ow.write(CMD_START_CONVERSION, 1);
+	check("strong pullup not supported", ow.getError() == ERROR_NOT_SUPPORTED);
+}
+
+//
+// Several buses on the same port, driven together
+//
+#define MULTI_BUSES 4
+
+static void multibus(void)
+{
+	OWsimWire wire[MULTI_BUSES];
+	OWsimDS18B20 *dev[MULTI_BUSES - 1];
+	uint8_t roms[8][8], v[8], sp[MULTI_BUSES][9], i, k;
+	unsigned long t0;
+	bool ok = true;
+
+	printf("OWmultibus, %u buses\n", MULTI_BUSES);
+	// pins 24 to 27 are port 3, bits 0 to 3: the last bus has no device
+	for (i = 0; i < MULTI_BUSES; i++)
+		wire[i].attach(24 + i);
+	memset(roms, 0, sizeof(roms));
+	for (i = 0; i < MULTI_BUSES - 1; i++) {
+		dev[i] = new OWsimDS18B20(0xA000 + i);
+		dev[i]->setTemperature(10 + i * 5.5);
+		wire[i].add(*dev[i]);
+		memcpy(roms[i], dev[i]->getRom(), 8);
+	}
+
+	OWmultibus mb(digitalPinToPort(24), (1 << MULTI_BUSES) - 1);
+	check("presence on the buses with a device", mb.reset() == 0x07);
+	mb.skip();
+	mb.write(CMD_START_CONVERSION);
+	delay(DS18B20_CONVERSION_TIME);
+
+	// each bus selects its own sensor, the scratchpads are read together
+	t0 = micros();
+	check("presence after the conversion", mb.reset() == 0x07);
+	mb.select(roms);
+	mb.write(CMD_READ_SCRATCHPAD);
+	for (k = 0; k < 9; k++) {
+		mb.read(v);
+		for (i = 0; i < MULTI_BUSES; i++)
+			sp[i][k] = v[i];
+	}
+	bench("3 scratchpads read at once", t0);
+	for (i = 0; i < MULTI_BUSES - 1; i++)
+		ok = ok && OWcomponent::crc8(sp[i], 8) == sp[i][8]
+			&& DS18B20::scratchpadToRaw(sp[i], FAM_CODE_DB18B20) == 160 + i * 88;
+	check("each bus read its own sensor", ok);
+	for (i = 0, ok = true; i < 9; i++)
+		ok = ok && sp[MULTI_BUSES - 1][i] == 0xFF;
+	check("bus without device reads ones", ok);
+
+	for (i = 0; i < MULTI_BUSES - 1; i++)
+		delete dev[i];
+}
+
+int main(void)
+{
+	sensor();
+	parasite();
+	ds18s20();
+	group();
+	mixed();
+	fleet();
+	validation();
+	profile();
+	faults();
+	overdrive();
+	hotplug();
+	uart();
+	multibus();
+
+	printf("%u failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * \file owuart_demo.cpp
+ * \brief Runs OWuart on a host against a mock serial port.
+ * \details A single virtual device answering READ ROM is wired to the mock
+ * serial port. The program checks the slot encoding, then reads the ROM of
+ * the device through OWuart and prints it together with the simulated bus
+ * time. Build and run it from this directory with:
+ * \code
+ *   g++ -std=gnu++11 -DARDUINO=100 -I. -I../.. owuart_demo.cpp Arduino.cpp \
+ *       ../../OWuart.cpp ../../OWcomponent.cpp ../../OWcrc.cpp -o owuart_demo
+ *   ./owuart_demo
+ * \endcode
+ * \author Enrico Formenti
+ * \version 0.1
+ * \date 2012-2013
+ * \warning The author is not responsible for any damage or...
+ * caused by this software. Use it at your own risk.
+ * \copyright BSD license. See license.txt for more details.
+ * All text above must be included in any redistribution.
+ */
+
+#include <stdio.h>
+#include "OWuart.h"
+
+static uint8_t rom[8] = { 0x28, 0xFF, 0x4C, 0x06, 0x15, 0x16, 0x03, 0x00 };
+
+// Virtual device: it listens to the ROM command, then sends its ROM
+static uint8_t rxByte, rxBits, txBit;
+static bool sending;
+
+static uint8_t device(unsigned long baud, uint8_t tx)
+{
+	if (baud < 100000) {
+		// reset pulse: answer with a presence pulse
+		rxByte = rxBits = txBit = 0;
+		sending = false;
+		return tx == OWUART_RESET ? 0xE0 : tx;
+	}
+	if (sending) {
+		// a 0 is sent by holding the bus low a while after the start bit
+		uint8_t bit = (rom[txBit >> 3] >> (txBit & 7)) & 1;
+		txBit = (txBit + 1) & 63;
+		return (tx == OWUART_SLOT_1 && !bit) ? 0xFC : tx;
+	}
+	rxByte >>= 1;
+	if (tx == OWUART_SLOT_1)
+		rxByte |= 0x80;
+	if (++rxBits == 8 && rxByte == CMD_READ_ROM)
+		sending = true;
+	return tx;
+}
+
+int main(void)
+{
+	uint8_t slots[8], buf[8], i;
+	unsigned long t0;
+	OWstats stats;
+	bool ok = true;
+
+	// encoding round trip
+	for (i = 0; i < 255; i++) {
+		OWuart::encode(i, slots);
+		if (OWuart::decode(slots) != i)
+			ok = false;
+	}
+	printf("slot encoding: %s\n", ok ? "ok" : "WRONG");
+	printf("presence: none %d, device %d, short %d\n",
+	       OWuart::presence(OWUART_RESET), OWuart::presence(0xE0), OWuart::presence(0x00));
+
+	rom[7] = OWcomponent::crc8(rom, 7);
+	Serial1.attach(device);
+	OWuart ow(Serial1);
+	ow.begin();
+
+	t0 = micros();
+	if (!ow.reset()) {
+		printf("no presence pulse\n");
+		return 1;
+	}
+	ow.write(CMD_READ_ROM);
+	ok = ow.read_bytes_crc8(buf, 8);
+	printf("ROM:");
+	for (i = 0; i < 8; i++)
+		printf(" %02X", buf[i]);
+	printf(" (CRC %s, %lu us)\n", ok ? "ok" : "WRONG", micros() - t0);
+
+	ow.getStats(&stats);
+	printf("resets %lu, no presence %u, bytes written %lu, bytes read %lu\n",
+	       (unsigned long)stats.resets, stats.noPresence,
+	       (unsigned long)stats.bytesWritten, (unsigned long)stats.bytesRead);
+
+	return ok ? 0 : 1;
+}